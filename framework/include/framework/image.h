@@ -4,19 +4,39 @@
 #include <framework/disable_all_warnings.h>
 DISABLE_WARNINGS_PUSH()
 #include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
 DISABLE_WARNINGS_POP()
 
 #include <array>
 #include <filesystem>
+#include <memory>
+#include <span>
 #include <stdint.h>
 #include <vector>
 
 struct Image {
 public:
     Image(const std::filesystem::path& filePath);
+    Image(const Image& other);
+    Image(Image&&) noexcept = default;
+    Image& operator=(const Image& other);
+    Image& operator=(Image&&) noexcept = default;
 
-    std::vector<uint8_t> getTexel(const glm::vec2& textureCoordinates) const;
+    // All accessors are allocation-free views into the decoded buffer (rows top to bottom, channels interleaved)
+    std::span<const uint8_t> pixels() const { return { m_pixels.get(), byteSize() }; }
+    std::span<uint8_t> pixels() { return { m_pixels.get(), byteSize() }; }
+    std::span<const uint8_t> getTexel(const glm::ivec2& pixel) const; // Clamped to the image edges
+    std::span<const uint8_t> getTexel(const glm::vec2& textureCoordinates) const; // Nearest texel
+    glm::vec4 sampleBilinear(const glm::vec2& textureCoordinates) const; // Channels in [0, 1]; missing channels are 0 (alpha 1)
 
     int32_t width, height, channels;
-    std::vector<uint8_t> pixels;
+
+private:
+    struct StbDeleter {
+        void operator()(uint8_t* stbPixels) const;
+    };
+
+    size_t byteSize() const { return static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(channels); }
+
+    std::unique_ptr<uint8_t[], StbDeleter> m_pixels; // Owned stb_image buffer, no copy made after decoding
 };
@@ -4,37 +4,74 @@
 DISABLE_WARNINGS_PUSH()
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
+#include <glm/common.hpp>
+#include <glm/vec2.hpp>
 DISABLE_WARNINGS_POP()
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
 #include <iostream>
+#include <new>
 #include <string>
 
+void Image::StbDeleter::operator()(uint8_t* stbPixels) const { stbi_image_free(stbPixels); }
+
 Image::Image(const std::filesystem::path& filePath) {
 	if (!std::filesystem::exists(filePath)) {
 		std::cerr << "Texture file " << filePath << " does not exist!" << std::endl;
 		throw std::exception();
 	}
 
+	// Take ownership of the buffer stb_image decoded into rather than copying it
 	const auto filePathStr = filePath.string(); // Create l-value so c_str() is safe.
-	stbi_uc* stbPixels = stbi_load(filePathStr.c_str(), &width, &height, &channels, STBI_default);
+	m_pixels.reset(stbi_load(filePathStr.c_str(), &width, &height, &channels, STBI_default));
 
-	if (!stbPixels) {
+	if (!m_pixels) {
 		std::cerr << "Failed to read texture " << filePath << " using stb_image.h" << std::endl;
 		throw std::exception();
 	}
+}
+
+Image::Image(const Image& other)
+	: width(other.width)
+	, height(other.height)
+	, channels(other.channels) {
+	// Allocate the same way stb_image does (STBI_MALLOC) so that the deleter stays valid for copies
+	m_pixels.reset(static_cast<uint8_t*>(std::malloc(byteSize())));
+	if (!m_pixels) { throw std::bad_alloc(); }
+	std::memcpy(m_pixels.get(), other.m_pixels.get(), byteSize());
+}
 
-	for (size_t i = 0UL; i < width * height * channels; i++) { pixels.emplace_back(stbPixels[i]); }
+Image& Image::operator=(const Image& other) {
+	if (this != &other) { *this = Image(other); }
+	return *this;
+}
+
+std::span<const uint8_t> Image::getTexel(const glm::ivec2& pixel) const {
+	const glm::ivec2 clampedPixel	= glm::clamp(pixel, glm::ivec2(0), glm::ivec2(width - 1, height - 1));
+	const size_t pixelOffset		= (static_cast<size_t>(clampedPixel.y) * static_cast<size_t>(width) + static_cast<size_t>(clampedPixel.x)) * static_cast<size_t>(channels);
+	return pixels().subspan(pixelOffset, static_cast<size_t>(channels));
+}
 
-	stbi_image_free(stbPixels);
+std::span<const uint8_t> Image::getTexel(const glm::vec2& textureCoordinates) const {
+	return getTexel(glm::ivec2(glm::floor(textureCoordinates * glm::vec2(width, height))));
 }
 
-std::vector<uint8_t> Image::getTexel(const glm::vec2& textureCoordinates) const {
-	const glm::ivec2 pixel 		= glm::ivec2(textureCoordinates * glm::vec2(width, height) + 0.5f);
-	const size_t pixelOffset	= pixel.y * width + pixel.x;
+glm::vec4 Image::sampleBilinear(const glm::vec2& textureCoordinates) const {
+	// Texel centers sit at half-integer coordinates; blend the four surrounding texels
+	const glm::vec2 texelCoordinates	= textureCoordinates * glm::vec2(width, height) - 0.5f;
+	const glm::vec2 baseTexel			= glm::floor(texelCoordinates);
+	const glm::vec2 weights				= texelCoordinates - baseTexel;
+	const glm::ivec2 base				= glm::ivec2(baseTexel);
 
-	// Return appropriate number of channels
-	std::vector<uint8_t> pixelData;
-	for (size_t i = pixelOffset; i < pixelOffset + channels; i++) { pixelData.push_back(pixels[i]); }
-	return pixelData;
+	const auto load = [this](const glm::ivec2& pixel) {
+		const std::span<const uint8_t> texel = getTexel(pixel);
+		glm::vec4 value(0.0f, 0.0f, 0.0f, 1.0f);
+		for (size_t channel = 0UL; channel < texel.size(); channel++) { value[static_cast<glm::length_t>(channel)] = static_cast<float>(texel[channel]) / 255.0f; }
+		return value;
+	};
+	const glm::vec4 top		= glm::mix(load(base),						load(base + glm::ivec2(1, 0)), weights.x);
+	const glm::vec4 bottom	= glm::mix(load(base + glm::ivec2(0, 1)),	load(base + glm::ivec2(1, 1)), weights.x);
+	return glm::mix(top, bottom, weights.y);
 }
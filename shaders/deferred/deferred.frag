@@ -1,45 +1,41 @@
 #version 460
 
-// Albedo data
-layout(location = 3) uniform sampler2D albedoTex;
-layout(location = 4) uniform bool hasAlbedo;
-layout(location = 5) uniform vec4 defaultAlbedo;
-
-// Normal map data
-layout(location = 6) uniform sampler2D normalTex;
-layout(location = 7) uniform bool hasNormal;
-
-// Metallic data
-layout(location = 8) uniform sampler2D metallicTex;
-layout(location = 9) uniform bool hasMetallic;
-layout(location = 10) uniform float defaultMetallic;
-
-// Roughness data
-layout(location = 11) uniform sampler2D roughnessTex;
-layout(location = 12) uniform bool hasRoughness;
-layout(location = 13) uniform float defaultRoughness;
-
-// AO map data
-layout(location = 14) uniform sampler2D aoTex;
-layout(location = 15) uniform bool hasAO;
-layout(location = 16) uniform float defaultAO;
-
-// Displacement map data
-layout(location = 17) uniform sampler2D displacementTex;
-layout(location = 18) uniform bool hasDisplacement;
-layout(location = 19) uniform bool displacementIsHeight;
-layout(location = 20) uniform float heightScale;    // Controls strength of parallax effect
-layout(location = 21) uniform float minDepthLayers; // Min number of samples to use to approximate depth at intersection point
-layout(location = 22) uniform float maxDepthLayers; // Max number of samples to use to approximate depth at intersection point
+// Must match MaterialShader in src/render/material.h. Layers are -1 if the material does not have the given texture (or it is not resident)
+struct Material {
+    vec4 defaultAlbedo;
+    int albedoLayer;
+    int normalLayer;
+    int metallicLayer;
+    int roughnessLayer;
+    int aoLayer;
+    int displacementLayer;
+    uint displacementIsHeight;
+    float defaultMetallic;
+    float defaultRoughness;
+    float defaultAO;
+    uint packedMinLods;     // 4 bits per texture (same order as the layers): finest mip level resident for that texture
+};
+layout(std430, binding = 5) readonly buffer MaterialBuffer { Material materials[]; };
+
+// Material textures
+layout(location = 4) uniform sampler2DArray colorTextures;     // Albedo
+layout(location = 5) uniform sampler2DArray normalTextures;    // Normal maps
+layout(location = 6) uniform sampler2DArray scalarTextures;    // Metallic, roughness, AO, and displacement maps
+
+// Parallax mapping data
+layout(location = 7) uniform float heightScale;    // Controls strength of parallax effect
+layout(location = 8) uniform float minDepthLayers; // Min number of samples to use to approximate depth at intersection point
+layout(location = 9) uniform float maxDepthLayers; // Max number of samples to use to approximate depth at intersection point
 
 // Camera position
-layout(location = 23) uniform vec3 cameraPos;
+layout(location = 10) uniform vec3 cameraPos;
 
 // Input from vertex shader
 layout(location = 0) in vec3 fragPos;
 layout(location = 1) in vec3 fragNormal;
 layout(location = 2) in vec2 fragTexCoord;
 layout(location = 3) in mat3 tbn;          // TBN matrix for normal and/or displacement map(s) transformation(s)
+layout(location = 6) flat in uint fragMaterialIdx;
 
 // G-buffer output
 layout(location = 0) out vec3 gPosition;    // Position buffer
@@ -47,7 +43,20 @@ layout(location = 1) out vec3 gNormal;      // Normal buffer
 layout(location = 2) out vec4 gAlbedo;      // Albedo buffer
 layout(location = 3) out vec3 gMaterial;    // Red channel is metallic, green channel is roughness, blue channel is AO
 
-vec2 parallaxMapping() {
+// Material textures are all the same size, so the LOD is computed once from the undisplaced coordinates
+float materialLod;
+
+// Mips finer than the streamed-in ones are garbage, so sampling is clamped to the finest resident level
+float sampleLod(Material material, uint textureSlot) {
+    return max(materialLod, float((material.packedMinLods >> (4u * textureSlot)) & 0xFu));
+}
+
+float sampleDepth(Material material, vec2 texCoords) {
+    float displacement = textureLod(scalarTextures, vec3(texCoords, material.displacementLayer), sampleLod(material, 5u)).r;
+    return material.displacementIsHeight != 0 ? 1.0 - displacement : displacement;
+}
+
+vec2 parallaxMapping(Material material) {
     vec3 fragToCamera       = normalize(tbn * (cameraPos - fragPos));                                                   // This vector is in tangent space
     float numDepthLayers    = mix(maxDepthLayers, minDepthLayers, max(dot(vec3(0.0, 0.0, 1.0), fragToCamera), 0.0));    // Scale number of samples based on how sharp the view angle on the surface is (sharper angle => closer to maxLayers)
     float layerDepth        = 1.0 / numDepthLayers;
@@ -57,50 +66,52 @@ vec2 parallaxMapping() {
 
     // Continually sample until we find a depth (in the depth map) below the theoretical real depth we are currently testing
     vec2 currentTexCoords       = fragTexCoord;
-    float currentDepthMapValue  = displacementIsHeight ? 1.0 - texture(displacementTex, currentTexCoords).r : texture(displacementTex, currentTexCoords).r;    
+    float currentDepthMapValue  = sampleDepth(material, currentTexCoords);
     while (currentLayerDepth < currentDepthMapValue) {
         currentTexCoords        -= deltaTexCoords;                             // Shift texture coordinates along opposite direction of P
-        currentDepthMapValue    = displacementIsHeight ? 1.0 - texture(displacementTex, currentTexCoords).r : texture(displacementTex, currentTexCoords).r; // Get depthmap value at current texture coordinates
+        currentDepthMapValue    = sampleDepth(material, currentTexCoords);     // Get depthmap value at current texture coordinates
         currentLayerDepth       += layerDepth;                                // Get depth of next layer
     }
 
     // Linearly interpolate between post hit depth and the depth value of the previous sample
     vec2 prevTexCoords  = currentTexCoords -= deltaTexCoords;
-    float beforeDepth   = (displacementIsHeight ? 1.0 - texture(displacementTex, currentTexCoords).r : texture(displacementTex, currentTexCoords).r) - currentLayerDepth + layerDepth;
+    float beforeDepth   = sampleDepth(material, currentTexCoords) - currentLayerDepth + layerDepth;
     float afterDepth    = currentDepthMapValue - currentLayerDepth;
     float weight        = afterDepth / (afterDepth - beforeDepth);
     return (prevTexCoords * weight) + (currentTexCoords * (1.0 - weight));
 } 
 
 void main() {
+    Material material = materials[fragMaterialIdx];
+    materialLod = textureQueryLod(colorTextures, fragTexCoord).y;
     gPosition = fragPos;
 
     // Transform texture coords if height map is present
     // You might want to add culling of fragments with coords outside the [0, 1] range post parallax mapping here,
     // but we abuse texture tiling in this project, so we do not
     vec2 finalTexCoords;
-    if (hasDisplacement) { finalTexCoords = parallaxMapping(); } else { finalTexCoords = fragTexCoord; }
+    if (material.displacementLayer >= 0) { finalTexCoords = parallaxMapping(material); } else { finalTexCoords = fragTexCoord; }
     
     // Normal
-    if (hasNormal) { 
-        gNormal = texture(normalTex, finalTexCoords).rgb;
-        gNormal = gNormal * 2.0 - 1.0;   
+    if (material.normalLayer >= 0) { 
+        vec2 normalXY = textureLod(normalTextures, vec3(finalTexCoords, material.normalLayer), sampleLod(material, 1u)).rg * 2.0 - 1.0; // BC5 only stores X and Y
+        gNormal = vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0)));
         gNormal = normalize(tbn * gNormal); 
     } else { gNormal = normalize(fragNormal); }
 
     // Albedo
-    if (hasAlbedo)  { gAlbedo = texture(albedoTex, finalTexCoords); }
-    else            { gAlbedo = defaultAlbedo; }
+    if (material.albedoLayer >= 0)  { gAlbedo = textureLod(colorTextures, vec3(finalTexCoords, material.albedoLayer), sampleLod(material, 0u)); }
+    else                            { gAlbedo = material.defaultAlbedo; }
 
     // Metallic
-    if (hasMetallic)    { gMaterial.r = texture(metallicTex, finalTexCoords).r; }
-    else                { gMaterial.r = defaultMetallic; }
+    if (material.metallicLayer >= 0)    { gMaterial.r = textureLod(scalarTextures, vec3(finalTexCoords, material.metallicLayer), sampleLod(material, 2u)).r; }
+    else                                { gMaterial.r = material.defaultMetallic; }
 
     // Roughness
-    if (hasRoughness)   { gMaterial.g = texture(roughnessTex, finalTexCoords).r; }
-    else                { gMaterial.g = defaultRoughness; }
+    if (material.roughnessLayer >= 0)   { gMaterial.g = textureLod(scalarTextures, vec3(finalTexCoords, material.roughnessLayer), sampleLod(material, 3u)).r; }
+    else                                { gMaterial.g = material.defaultRoughness; }
 
     // AO
-    if (hasAO)  { gMaterial.b = texture(aoTex, finalTexCoords).r; }
-    else        { gMaterial.b = defaultAO; }
+    if (material.aoLayer >= 0)  { gMaterial.b = textureLod(scalarTextures, vec3(finalTexCoords, material.aoLayer), sampleLod(material, 4u)).r; }
+    else                        { gMaterial.b = material.defaultAO; }
 }
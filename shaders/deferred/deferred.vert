@@ -5,44 +5,76 @@ layout(location = 0) uniform mat4 mvpMatrix;
 layout(location = 1) uniform mat4 modelMatrix;
 layout(location = 2) uniform mat3 normalModelMatrix; // Normals should be transformed differently than positions (https://paroj.github.io/gltut/Illumination/Tut09%20Normal%20Transformation.html)
 
-// Normal map data
-layout(location = 6) uniform sampler2D normalTex;
-layout(location = 7) uniform bool hasNormal;
+// Index into the material buffer, forwarded to the fragment shader
+layout(location = 3) uniform uint materialIdx;
 
-// Displacement map data
-layout(location = 17) uniform sampler2D displacementTex;
-layout(location = 18) uniform bool hasDisplacement;
-layout(location = 19) uniform bool displacementIsHeight;
+// Maps quantised positions back onto the mesh's bounding box
+layout(location = 11) uniform vec3 positionOffset;
+layout(location = 12) uniform vec3 positionScale;
 
-// Must match vertex properties definition
-layout(location = 0) in vec3 position;
-layout(location = 1) in vec3 normal;
+// Morph target animation: each pose's vertices as MorphVertex (src/utils/vertex_compression.hpp), see GPUMesh::bindMorphTargets
+layout(std430, binding = 6) readonly buffer MorphBuffer { uvec2 morphVertices[]; };
+layout(location = 13) uniform bool enableMorph;
+layout(location = 14) uniform uvec2 morphPoseOffsets;  // Offsets of the two blended poses in morphVertices
+layout(location = 15) uniform float morphWeight;       // Blend factor towards the second pose
+
+// Must match CompactVertex in src/utils/vertex_compression.hpp
+layout(location = 0) in vec4 quantizedPosition; // XYZ relative to the mesh's bounding box, W is the bitangent sign (0 => -1, 1 => +1)
+layout(location = 1) in vec2 octNormal;
 layout(location = 2) in vec2 texCoord;
-layout(location = 3) in vec3 tangent;
-layout(location = 4) in vec3 bitangent;
+layout(location = 3) in vec2 octTangent;
 
 // Must match vertex properties definition
 layout(location = 0) out vec3 fragPos;
 layout(location = 1) out vec3 fragNormal;
 layout(location = 2) out vec2 fragTexCoord; 
 layout(location = 3) out mat3 tbn;          // TBN matrix for normal map transformation
+layout(location = 6) flat out uint fragMaterialIdx;
+
+// Octahedral unit vector decoding (https://jcgt.org/published/0003/02/01/)
+vec3 octahedralDecode(vec2 encoded) {
+    vec3 unitVector = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold      = max(-unitVector.z, 0.0);
+    unitVector.x    += unitVector.x >= 0.0 ? -fold : fold;
+    unitVector.y    += unitVector.y >= 0.0 ? -fold : fold;
+    return normalize(unitVector);
+}
+
+// Quantised position (XY unorm16 in X, Z unorm16 in the low half of Y) and normal (octahedral unorm8 in the high half of Y)
+void decodeMorphVertex(uvec2 packedVertex, out vec3 position, out vec3 normal) {
+    position    = vec3(unpackUnorm2x16(packedVertex.x), unpackUnorm2x16(packedVertex.y).x);
+    normal      = octahedralDecode(unpackUnorm4x8(packedVertex.y).zw * 2.0 - 1.0);
+}
 
 void main() {
+    // Decode vertex
+    vec3 quantized  = quantizedPosition.xyz;
+    vec3 normal     = octahedralDecode(octNormal);
+    vec3 tangent    = octahedralDecode(octTangent);
+    if (enableMorph) {
+        uint vertexIdx = uint(gl_VertexID - gl_BaseVertex);
+        vec3 firstPosition, firstNormal, secondPosition, secondNormal;
+        decodeMorphVertex(morphVertices[morphPoseOffsets.x + vertexIdx], firstPosition, firstNormal);
+        decodeMorphVertex(morphVertices[morphPoseOffsets.y + vertexIdx], secondPosition, secondNormal);
+        quantized   = mix(firstPosition, secondPosition, morphWeight);
+        normal      = normalize(mix(firstNormal, secondNormal, morphWeight));
+        tangent     = normalize(tangent - normal * dot(normal, tangent)); // Poses do not store tangents, keep the rest pose's one perpendicular to the new normal
+    }
+    vec3 position   = positionOffset + quantized * positionScale;
+    vec3 bitangent  = (quantizedPosition.w * 2.0 - 1.0) * cross(normal, tangent);
+
     // Screen-space position
     gl_Position = mvpMatrix * vec4(position, 1.0);
 
-    // Compute TBN if needed for either normal or displacement map
-    if (hasNormal || hasDisplacement) { 
-        vec3 tangentCol     = normalize(vec3(modelMatrix * vec4(tangent,   0.0)));
-        vec3 bitangentCol   = normalize(vec3(modelMatrix * vec4(bitangent, 0.0)));
-        vec3 normalCol      = normalize(vec3(modelMatrix * vec4(normal,    0.0)));
-        tbn                 = mat3(tangentCol, bitangentCol, normalCol);
-    }
-
-    // Use fragment normal if a normal map is not provided
-    if (!hasNormal) { fragNormal = normalModelMatrix * normal; }
+    // TBN for normal and displacement maps, and fragment normal for materials without a normal map (which maps are present is only known per fragment)
+    vec3 tangentCol     = normalize(vec3(modelMatrix * vec4(tangent,   0.0)));
+    vec3 bitangentCol   = normalize(vec3(modelMatrix * vec4(bitangent, 0.0)));
+    vec3 normalCol      = normalize(vec3(modelMatrix * vec4(normal,    0.0)));
+    tbn                 = mat3(tangentCol, bitangentCol, normalCol);
+    fragNormal          = normalModelMatrix * normal;
     
     // World-space position and texture coords
     fragPos         = (modelMatrix * vec4(position, 1.0)).xyz;
     fragTexCoord    = texCoord;
+    fragMaterialIdx = materialIdx;
 }
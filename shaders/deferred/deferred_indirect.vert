@@ -0,0 +1,69 @@
+#version 460
+
+// Must match StaticInstanceShader in src/render/indirect.h
+struct Instance {
+    mat4 modelMatrix;
+    mat4 normalModelMatrix; // Only the upper 3x3 is used
+    vec4 boundsMin;
+    vec4 boundsMax;
+    uvec4 drawInfo;         // X-coordinate is the draw command index, Y-coordinate is the material index
+};
+
+// Instance data and indices of instances which survived culling
+layout(std430, binding = 2) readonly buffer InstanceBuffer  { Instance instances[]; };
+layout(std430, binding = 4) readonly buffer VisibleBuffer   { uint visibleInstances[]; };
+
+// Per-instance matrices come from the instance buffer, so only the camera matrix is a uniform
+layout(location = 0) uniform mat4 viewProjection;
+
+// Must match CompactVertex in src/utils/vertex_compression.hpp
+layout(location = 0) in vec4 quantizedPosition; // XYZ relative to the mesh's bounding box, W is the bitangent sign (0 => -1, 1 => +1)
+layout(location = 1) in vec2 octNormal;
+layout(location = 2) in vec2 texCoord;
+layout(location = 3) in vec2 octTangent;
+
+// Must match vertex properties definition
+layout(location = 0) out vec3 fragPos;
+layout(location = 1) out vec3 fragNormal;
+layout(location = 2) out vec2 fragTexCoord; 
+layout(location = 3) out mat3 tbn;          // TBN matrix for normal map transformation
+layout(location = 6) flat out uint fragMaterialIdx;
+
+// Octahedral unit vector decoding (https://jcgt.org/published/0003/02/01/)
+vec3 octahedralDecode(vec2 encoded) {
+    vec3 unitVector = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold      = max(-unitVector.z, 0.0);
+    unitVector.x    += unitVector.x >= 0.0 ? -fold : fold;
+    unitVector.y    += unitVector.y >= 0.0 ? -fold : fold;
+    return normalize(unitVector);
+}
+
+void main() {
+    // Each draw command's visible instances start at its base instance
+    Instance instance       = instances[visibleInstances[gl_BaseInstance + gl_InstanceID]];
+    mat4 modelMatrix        = instance.modelMatrix;
+    mat3 normalModelMatrix  = mat3(instance.normalModelMatrix);
+
+    // Decode vertex (quantised positions are relative to the bounding box, matching utils::positionScale)
+    vec3 positionScale  = max(instance.boundsMax.xyz - instance.boundsMin.xyz, vec3(1e-6));
+    vec3 position       = instance.boundsMin.xyz + quantizedPosition.xyz * positionScale;
+    vec3 normal         = octahedralDecode(octNormal);
+    vec3 tangent        = octahedralDecode(octTangent);
+    vec3 bitangent      = (quantizedPosition.w * 2.0 - 1.0) * cross(normal, tangent);
+
+    // Screen-space position
+    vec4 worldPos   = modelMatrix * vec4(position, 1.0);
+    gl_Position     = viewProjection * worldPos;
+
+    // TBN for normal and displacement maps, and fragment normal for materials without a normal map (which maps are present is only known per fragment)
+    vec3 tangentCol     = normalize(vec3(modelMatrix * vec4(tangent,   0.0)));
+    vec3 bitangentCol   = normalize(vec3(modelMatrix * vec4(bitangent, 0.0)));
+    vec3 normalCol      = normalize(vec3(modelMatrix * vec4(normal,    0.0)));
+    tbn                 = mat3(tangentCol, bitangentCol, normalCol);
+    fragNormal          = normalModelMatrix * normal;
+    
+    // World-space position and texture coords
+    fragPos         = worldPos.xyz;
+    fragTexCoord    = texCoord;
+    fragMaterialIdx = instance.drawInfo.y;
+}
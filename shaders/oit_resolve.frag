@@ -0,0 +1,19 @@
+#version 460
+
+// Weighted blended order-independent transparency targets
+layout(location = 0) uniform sampler2D accumulation;
+layout(location = 1) uniform sampler2D revealage;
+
+// Output, blended over the opaque HDR colour with (SRC_ALPHA, ONE_MINUS_SRC_ALPHA)
+layout(location = 0) out vec4 fragColor;
+
+void main() {
+    ivec2 texel                 = ivec2(gl_FragCoord.xy);
+    float remainingRevealage    = texelFetch(revealage, texel, 0).r;
+    if (remainingRevealage == 1.0) { discard; } // Nothing transparent covers this pixel
+
+    // Weighted average colour of all transparent fragments, covering (1 - revealage) of the background
+    vec4 weightedSum    = texelFetch(accumulation, texel, 0);
+    vec3 averageColor   = weightedSum.rgb / clamp(weightedSum.a, 1e-4, 5e4);
+    fragColor           = vec4(averageColor, 1.0 - remainingRevealage);
+}
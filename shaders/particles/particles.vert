@@ -1,15 +1,18 @@
 #version 460
 
 layout(location = 0) uniform mat4 viewProjection;
+layout(location = 5) uniform float interpolation; // Fraction of a simulation step from the previous position to the latest one
 
 layout(location = 0) in vec3 vertexPos;
 layout(location = 1) in vec3 particlePosition;
 layout(location = 2) in vec4 particleColor;
 layout(location = 3) in float particleSize;
+layout(location = 4) in vec3 particleVelocity;
 
 layout(location = 0) out vec4 fragParticleColor;
 
 void main() {
     fragParticleColor   = particleColor;
-    gl_Position         = viewProjection * vec4(particlePosition + (particleSize * vertexPos), 1.0);
+    vec3 position       = particlePosition - (1.0 - interpolation) * particleVelocity;
+    gl_Position         = viewProjection * vec4(position + (particleSize * vertexPos), 1.0);
 }
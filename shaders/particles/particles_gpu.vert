@@ -0,0 +1,28 @@
+#version 460
+
+// Must match GPUParticle in src/render/particle.h
+struct Particle {
+    vec3 position;
+    float life;
+    vec3 velocity;
+    float size;
+    vec4 color;
+};
+
+layout(std430, binding = 7) readonly buffer ParticleBuffer  { Particle particles[]; };
+layout(std430, binding = 9) readonly buffer SortBuffer      { uvec2 sortPairs[]; }; // (Key, particle index), back to front
+
+layout(location = 0) uniform mat4 viewProjection;
+layout(location = 4) uniform bool sorted; // Draw in the order of the sort pairs rather than per emitter range (base instance)
+layout(location = 5) uniform float interpolation; // Fraction of a simulation step from the previous position to the latest one
+
+layout(location = 0) in vec3 vertexPos;
+
+layout(location = 0) out vec4 fragParticleColor;
+
+void main() {
+    Particle particle   = particles[sorted ? sortPairs[gl_InstanceID].y : uint(gl_BaseInstance + gl_InstanceID)];
+    fragParticleColor   = particle.color;
+    vec3 position       = particle.position - (1.0 - interpolation) * particle.velocity;
+    gl_Position         = viewProjection * vec4(position + (particle.size * vertexPos), 1.0);
+}
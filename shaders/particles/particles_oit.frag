@@ -0,0 +1,15 @@
+#version 460
+
+layout(location = 0) in vec4 fragParticleColor;
+
+// Weighted blended order-independent transparency (McGuire & Bavoil 2013) targets
+layout(location = 0) out vec4 accumulation; // Weighted premultiplied colour and alpha, additively blended
+layout(location = 1) out float revealage;   // Product of (1 - alpha), multiplicatively blended
+
+void main() {
+    // Depth weight (equation 9 of the paper) favours particles near the camera; clamped to stay within 16-bit float range
+    float alpha     = fragParticleColor.a;
+    float weight    = alpha * clamp(3e3 * pow(1.0 - gl_FragCoord.z, 3.0), 1e-2, 3e3);
+    accumulation    = vec4(fragParticleColor.rgb * alpha, alpha) * weight;
+    revealage       = alpha;
+}
@@ -2,8 +2,21 @@
 
 layout(location = 0) uniform mat4 mvpMatrix;
 
-layout(location = 0) in vec3 position;
+// Morph target animation (same as shaders/deferred/deferred.vert, only positions are needed)
+layout(std430, binding = 6) readonly buffer MorphBuffer { uvec2 morphVertices[]; };
+layout(location = 13) uniform bool enableMorph;
+layout(location = 14) uniform uvec2 morphPoseOffsets;
+layout(location = 15) uniform float morphWeight;
+
+layout(location = 0) in vec3 quantizedPosition; // The dequantization is folded into the matrices
+
+vec3 morphPosition(uvec2 packedVertex) { return vec3(unpackUnorm2x16(packedVertex.x), unpackUnorm2x16(packedVertex.y).x); }
 
 void main() {
+    vec3 position = quantizedPosition;
+    if (enableMorph) {
+        uint vertexIdx  = uint(gl_VertexID - gl_BaseVertex);
+        position        = mix(morphPosition(morphVertices[morphPoseOffsets.x + vertexIdx]), morphPosition(morphVertices[morphPoseOffsets.y + vertexIdx]), morphWeight);
+    }
     gl_Position = mvpMatrix * vec4(position, 1);
 }
@@ -6,6 +6,7 @@
 // Suppress warnings in third-party code.
 #include <framework/disable_all_warnings.h>
 DISABLE_WARNINGS_PUSH()
+#include <glm/common.hpp>
 #include <glm/mat4x4.hpp>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
@@ -15,7 +16,7 @@ DISABLE_WARNINGS_POP()
 
 class EnemyCamera {
 public:
-    EnemyCamera(glm::vec4* cam, glm::vec4* stand, glm::vec3* cam_forward, glm::vec3* position, glm::vec3* color) : camera(cam), stand2(stand), cam_forward(cam_forward), position(position), color(color) {}
+    EnemyCamera(glm::vec4* cam, glm::vec4* stand, glm::vec3* cam_forward, glm::vec3* position, glm::vec3* color) : camera(cam), stand2(stand), cam_forward(cam_forward), position(position), color(color), previousSweepAngle(cam->w), sweepAngle(cam->w) {}
 
     glm::vec4* camera;
     glm::vec4* stand2;
@@ -25,6 +26,12 @@ public:
     bool motion_left    = true;
     bool motion_up      = true;
 
+    // Sweep angle (degrees) after the previous and the latest simulation step; the camera is drawn in between
+    float previousSweepAngle;
+    float sweepAngle;
+
+    void interpolateSweep(float interpolation) { camera->w = glm::mix(previousSweepAngle, sweepAngle, interpolation); }
+
     bool canSeePoint(glm::vec3 point) {
         float angle = glm::acos(glm::dot(glm::normalize(point - *position), glm::normalize(*cam_forward)));
 
@@ -68,14 +68,16 @@ void Board::addObjectsRoom(MeshTree* room, Defined* roomTile, const InitialState
             BezierCurve<glm::vec3> b3d              = BezierCurve<glm::vec3>(glm::vec3(-3.f, 2.f, 0.f), glm::vec3(-3.3f , 2.5f, 0.f), glm::vec3(-2.7f , 3.f, 0.f), glm::vec3(-3.f, 3.5f, 0.f), 10.f);
             BezierCurve<glm::vec3> b3d2             = BezierCurve<glm::vec3>(glm::vec3(-3.f, 3.5f, 0.f), glm::vec3(-2.7f , 3.f, 0.f), glm::vec3(-3.3f , 2.5f, 0.f), glm::vec3(-3.f, 2.f, 0.f), 10.f);
             BezierComposite<glm::vec3> b3c          = BezierComposite<glm::vec3>({b3d, b3d2}, true, 20.f);
-            BezierComboComposite<glm::vec3> combo   = BezierComboComposite<glm::vec3>(b3c, &retRoot->transform.translate, retRoot->shared_from_this());
-            initialState.bezierCurveManager.add3dComposite(combo);
+            initialState.bezierCurveManager.add3dComposite(b3c, *retRoot, utils::BEZIER_ARC_LENGTH_SAMPLES);
 
-            BezierCurve<glm::vec4> b4d              = BezierCurve<glm::vec4>(glm::vec4(0.f, 0.f, 0.f, 1.f), glm::vec4(0.f , 0.3826834f, 0.f, 0.9238795f), glm::vec4(0.f , 0.7132504f, 0.f, 0.7009093f), glm::vec4(0.f , 1.f, 0.f, 0.f), 10.f);
-            BezierCurve<glm::vec4> b4d2             = BezierCurve<glm::vec4>(glm::vec4(0.f , 1.f, 0.f, 0.f) , glm::vec4(0.f , -0.7132504f, 0.f, 0.7009093f), glm::vec4(0.f , -0.3826834f, 0.f, 0.9238795f),  glm::vec4(0.f, -0.0005f, 0.f, 0.9999999f), 10.f);
-            BezierComposite<glm::vec4> b4c          = BezierComposite<glm::vec4>({b4d, b4d2}, true, 20.f);
-            BezierComboComposite<glm::vec4> combo2  = BezierComboComposite<glm::vec4>(b4c, &retRoot->transform.selfRotate, retRoot->shared_from_this());
-            initialState.bezierCurveManager.add4dComposite(combo2);
+            // One full turn around Y every 20 seconds (keys a quarter turn apart, since each segment takes the shortest arc)
+            std::vector<float> spinTimes;
+            std::vector<glm::quat> spinKeys;
+            for (float quarterTurn = 0.0f; quarterTurn <= 4.0f; quarterTurn += 1.0f) {
+                spinTimes.push_back(5.0f * quarterTurn);
+                spinKeys.push_back(glm::angleAxis(glm::radians(90.0f * quarterTurn), glm::vec3(0.0f, 1.0f, 0.0f)));
+            }
+            initialState.bezierCurveManager.addRotation(RotationTrack(spinTimes, spinKeys, true), *retRoot);
             initialState.monkeyHeads.push_back(retRoot->shared_from_this());
         }
     }
@@ -100,22 +102,27 @@ void Board::load(Defined*** boardCopy, const InitialState& initialState, size_t
                         MeshTree* pillarTL = new MeshTree(
                             "pillarTL", initialState.pillarTL.second, initialState.pillarTL.first);
                         MemoryManager::addEl(pillarTL);
+                        pillarTL->isStatic = true;
                         crossingTile->addChild(pillarTL->shared_from_this());
                         MeshTree* pillarBL = new MeshTree(
                             "pillarBL", initialState.pillarBL.second, initialState.pillarBL.first);
                         MemoryManager::addEl(pillarBL);
+                        pillarBL->isStatic = true;
                         crossingTile->addChild(pillarBL->shared_from_this());
                         MeshTree* pillarBR = new MeshTree(
                             "pillarBL", initialState.pillarBR.second, initialState.pillarBR.first);
                         MemoryManager::addEl(pillarBR);
+                        pillarBR->isStatic = true;
                         crossingTile->addChild(pillarBR->shared_from_this());
                         MeshTree* pillarTR = new MeshTree(
                             "pillarBL", initialState.pillarTR.second, initialState.pillarTR.first);
                         MemoryManager::addEl(pillarTR);
+                        pillarTR->isStatic = true;
                         crossingTile->addChild(pillarTR->shared_from_this());
                         MeshTree* floorT = new MeshTree(
                             "floor", initialState.floor.second, initialState.floor.first);
                         MemoryManager::addEl(floorT);
+                        floorT->isStatic = true;
                         crossingTile->addChild(floorT->shared_from_this());
                         break;
                     } case TileType::ROOM1: {
@@ -282,12 +289,15 @@ void Board::load(Defined*** boardCopy, const InitialState& initialState, size_t
                         break;
                     }
                 }
+
+                // Tiles never move relative to the board, so they can be batched and culled on the GPU
+                if (boardCopy[i][j]->tileType != TileType::INVALID) { board[i][j]->isStatic = true; }
             }
         }
     fix_translations();
 }
 
-void Board::shiftLeft(LightManager& lightManager, ParticleEmitterManager& particleEmitterManager) {
+void Board::shiftLeft(LightManager& lightManager, ParticleEmitterManager& particleEmitterManager, BezierCurveManager& bezierCurveManager) {
     // We shift two columns to the left
     constexpr size_t lastColumn         = utils::TILES_PER_ROW - 1UL;
     constexpr size_t secondToLastColumn = utils::TILES_PER_ROW - 2UL;
@@ -296,7 +306,7 @@ void Board::shiftLeft(LightManager& lightManager, ParticleEmitterManager& partic
     // Remove old tiles
     for (size_t i = 0UL; i < utils::TILES_PER_ROW; i++) {
         for (size_t j = lastColumn; j >= secondToLastColumn; j--) {
-            board[i][j]->clean(lightManager, particleEmitterManager);
+            board[i][j]->clean(lightManager, particleEmitterManager, bezierCurveManager);
             MemoryManager::removeEl(board[i][j]);
         }
     }
@@ -309,7 +319,7 @@ void Board::shiftLeft(LightManager& lightManager, ParticleEmitterManager& partic
     }
 }
 
-void Board::shiftDown(LightManager& lightManager, ParticleEmitterManager& particleEmitterManager) {
+void Board::shiftDown(LightManager& lightManager, ParticleEmitterManager& particleEmitterManager, BezierCurveManager& bezierCurveManager) {
     // We shift two rows down
     constexpr size_t thirdRow        = 2UL;
     constexpr size_t secondToLastRow = utils::TILES_PER_ROW - 2UL;
@@ -317,7 +327,7 @@ void Board::shiftDown(LightManager& lightManager, ParticleEmitterManager& partic
     // Remove old tiles
     for (size_t j = 0UL; j < utils::TILES_PER_ROW; j++) {
         for (size_t i = 0UL; i < thirdRow; i++) {
-            board[i][j]->clean(lightManager, particleEmitterManager);
+            board[i][j]->clean(lightManager, particleEmitterManager, bezierCurveManager);
             MemoryManager::removeEl(board[i][j]);
         }
     }
@@ -330,14 +340,14 @@ void Board::shiftDown(LightManager& lightManager, ParticleEmitterManager& partic
     }
 }
 
-void Board::shiftRight(LightManager& lightManager, ParticleEmitterManager& particleEmitterManager) {
+void Board::shiftRight(LightManager& lightManager, ParticleEmitterManager& particleEmitterManager, BezierCurveManager& bezierCurveManager) {
     // We shift two columns to the right
     constexpr size_t thirdColumn        = 2UL;
     constexpr size_t secondToLastColumn = utils::TILES_PER_ROW - 2UL;
 
     for (size_t i = 0UL; i < utils::TILES_PER_ROW; i++) {
         for (size_t j = 0UL; j < thirdColumn; j++) {
-            board[i][j]->clean(lightManager, particleEmitterManager);
+            board[i][j]->clean(lightManager, particleEmitterManager, bezierCurveManager);
             MemoryManager::removeEl(board[i][j]);
         }
     }
@@ -350,7 +360,7 @@ void Board::shiftRight(LightManager& lightManager, ParticleEmitterManager& parti
     }
 }
 
-void Board::shiftUp(LightManager& lightManager, ParticleEmitterManager& particleEmitterManager) {
+void Board::shiftUp(LightManager& lightManager, ParticleEmitterManager& particleEmitterManager, BezierCurveManager& bezierCurveManager) {
     // We shift two rows up
     constexpr size_t lastRow            = utils::TILES_PER_ROW - 1UL;
     constexpr size_t secondToLastRow    = utils::TILES_PER_ROW - 2UL;
@@ -359,7 +369,7 @@ void Board::shiftUp(LightManager& lightManager, ParticleEmitterManager& particle
     // Remove old tiles
     for (size_t j = 0UL; j < 7UL; j++) {
         for (size_t i = 6; i >= secondToLastRow; i--) {
-            board[i][j]->clean(lightManager, particleEmitterManager);
+            board[i][j]->clean(lightManager, particleEmitterManager, bezierCurveManager);
             MemoryManager::removeEl(board[i][j]);                
         }
     }
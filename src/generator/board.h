@@ -53,10 +53,10 @@ public:
     void addObjectsRoom(MeshTree* room, Defined* roomTile, const InitialState& initialState);
     void load(Defined*** boardCopy, const InitialState& initialState, size_t startI, size_t stopI, size_t startY, size_t stopY);
 
-    void shiftLeft(LightManager& lightManager,  ParticleEmitterManager& particleEmitterManager);
-    void shiftDown(LightManager& lightManager,  ParticleEmitterManager& particleEmitterManager);
-    void shiftRight(LightManager& lightManager, ParticleEmitterManager& particleEmitterManager);
-    void shiftUp(LightManager& lightManager,    ParticleEmitterManager& particleEmitterManager);
+    void shiftLeft(LightManager& lightManager,  ParticleEmitterManager& particleEmitterManager, BezierCurveManager& bezierCurveManager);
+    void shiftDown(LightManager& lightManager,  ParticleEmitterManager& particleEmitterManager, BezierCurveManager& bezierCurveManager);
+    void shiftRight(LightManager& lightManager, ParticleEmitterManager& particleEmitterManager, BezierCurveManager& bezierCurveManager);
+    void shiftUp(LightManager& lightManager,    ParticleEmitterManager& particleEmitterManager, BezierCurveManager& bezierCurveManager);
 
     HeptaGrid board;
 };
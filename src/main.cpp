@@ -9,11 +9,15 @@ DISABLE_WARNINGS_POP()
 #include <gameplay/enemy_camera.h>
 #include <generator/board.h>
 #include <generator/generator.h>
+#include <render/asset_bundle.h>
+#include <render/asset_loader.h>
 #include <render/bezier.h>
 #include <render/config.h>
 #include <render/deferred.h>
+#include <render/geometry_arena.h>
 #include <render/lighting.h>
 #include <render/mesh.h>
+#include <render/mesh_cache.h>
 #include <render/particle.h>
 #include <render/scene.h>
 #include <render/texture.h>
@@ -21,12 +25,15 @@ DISABLE_WARNINGS_POP()
 #include <ui/menu.h>
 #include <utils/constants.h>
 #include <utils/cutscene_utils.hpp>
+#include <utils/fixed_timestep.hpp>
 #include <utils/hitbox.hpp>
+#include <utils/job_system.hpp>
 #include <utils/render_utils.hpp>
 
 #include <mutex>
 #include <condition_variable>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <vector>
 #include <ctime>
@@ -152,6 +159,7 @@ void makeCameraMoves(glm::vec3 playerPos, std::chrono::time_point<std::chrono::h
             continue;
         }
         std::shared_ptr<EnemyCamera> cam = cameras.at(i).lock();
+        cam.get()->previousSweepAngle = cam.get()->sweepAngle;
         // IF PLAYER IN VIEW DO STUFF
         if(!xToonPowerUp  && cam.get()->canSeePoint(playerPos, 15.f)){
             if(!playerDetected){
@@ -166,18 +174,18 @@ void makeCameraMoves(glm::vec3 playerPos, std::chrono::time_point<std::chrono::h
         }
         // OTHERWISE:
         if(cam.get()->motion_left){
-            if(cam.get()->camera->w <= -45.f){
+            if(cam.get()->sweepAngle <= -45.f){
                 cam.get()->motion_left = false;
-                cam.get()->camera->w += 2.f;
+                cam.get()->sweepAngle += 2.f;
             }else{
-                cam.get()->camera->w -= 2.f;
+                cam.get()->sweepAngle -= 2.f;
             }
         }else{
-            if(cam.get()->camera->w >= 45.f){
+            if(cam.get()->sweepAngle >= 45.f){
                 cam.get()->motion_left = true;
-                cam.get()->camera->w -= 2.f;
+                cam.get()->sweepAngle -= 2.f;
             }else{
-                cam.get()->camera->w += 2.f;
+                cam.get()->sweepAngle += 2.f;
             }
         }
     }
@@ -197,7 +205,9 @@ int main(int argc, char* argv[]) {
 
     // Init core objects
     RenderConfig renderConfig;
+    utils::JobSystem jobSystem; // Per-frame CPU work (animation, scene graph and particles); the maze generation thread is separate
     Window m_window("Final Project", glm::ivec2(utils::WIDTH, utils::HEIGHT), OpenGLVersion::GL46);
+    GeometryArena geometryArena(utils::GEOMETRY_ARENA_INITIAL_VERTICES, utils::GEOMETRY_ARENA_INITIAL_INDEX_BYTES); // Must outlive all GPU meshes
     Camera mainCamera(&m_window, renderConfig, glm::vec3(2.0f, 3.0f, 0.0f), -glm::vec3(1.0f, 1.1f, 0.0f));
     Camera playerCamera(&m_window, renderConfig, playerCameraPos, (playerPos - playerCameraPos) + glm::vec3(0.f,1.f,0.f));
     playerCamera.update = &motion;
@@ -227,76 +237,115 @@ int main(int argc, char* argv[]) {
     constexpr std::string_view textureNormal        = "normal_map_opengl.jpg";
     constexpr std::string_view textureRoughness     = "roughness_map.jpg";
 
+    /********** Asset loading **********/
+    // Cooked assets are read from a single bundle (rewritten at the end of loading if anything was missing from it)
+    // Decoding and parsing run on worker threads; GL uploads are queued for this thread and drained whenever it waits on a load
+    AssetBundle assetBundle(utils::RESOURCES_DIR_PATH / "cache" / "assets.bundle");
+    AssetLoader assetLoader(utils::ASSET_UPLOAD_QUEUE_CAPACITY);
+    const auto loadMeshAsync = [&assetLoader, &assetBundle](std::filesystem::path filePath) {
+        return assetLoader.submit([filePath, &assetBundle]() { return loadCookedMesh(filePath, assetBundle); });
+    };
+
+    // Start all mesh loads up front so they overlap with each other and with texture decoding
+    std::future<CookedMesh> apertureLoad  = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "aperture.obj");
+    std::future<CookedMesh> cameraLoad    = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "camera.obj");
+    std::future<CookedMesh> stand1Load    = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "stand1.obj");
+    std::future<CookedMesh> stand2Load    = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "stand2.obj");
+    std::future<CookedMesh> suzanneLoad   = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "suzanne.obj");
+    std::future<CookedMesh> crossingLoad  = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "crossing.obj");
+    std::future<CookedMesh> roomLoad      = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "room.obj");
+    std::future<CookedMesh> tjunctionLoad = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "tjunction.obj");
+    std::future<CookedMesh> tunnelLoad    = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "tunnel.obj");
+    std::future<CookedMesh> turnLoad      = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "turn.obj");
+    std::future<CookedMesh> floorLoad     = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "floor.obj");
+    std::future<CookedMesh> pillarBLLoad  = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "pillar_bottom_left.obj");
+    std::future<CookedMesh> pillarBRLoad  = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "pillar-bottom-right.obj");
+    std::future<CookedMesh> pillarTLLoad  = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "pillar-top-left.obj");
+    std::future<CookedMesh> pillarTRLoad  = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "pillar-top-right.obj");
+    std::future<CookedMesh> wallHRLoad    = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "walf-half-right.obj");
+    std::future<CookedMesh> wallHBLoad    = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "wall-half-bottom.obj");
+    std::future<CookedMesh> wallHTLoad    = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "wall-half-top.obj");
+    std::future<CookedMesh> wallFBLoad    = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "wall-full-bottom.obj");
+    std::future<CookedMesh> wallFRLoad    = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "wall-full-right.obj");
+    std::future<CookedMesh> wallFTLoad    = loadMeshAsync(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "wall-full-top.obj");
+    std::vector<std::filesystem::path> monkeyPosePaths;
+    for (size_t i = 0UL; i < 16UL; i++) {
+        auto fileName = "monkeypose" + std::to_string(i * 2) + ".obj";
+        monkeyPosePaths.push_back(utils::RESOURCES_DIR_PATH / "models" / "animated" / fileName);
+    }
+    std::future<CookedMorphMesh> monkeyLoad = assetLoader.submit([&monkeyPosePaths, &assetBundle]() { return loadCookedMorphMesh(monkeyPosePaths, assetBundle); });
+    /*************************************/
+
     /********** Texture loading **********/
     // Crystal
     std::filesystem::path crystalTextureFolder = utils::RESOURCES_DIR_PATH / "textures" / "Crystal";
     std::array<std::string, 7UL> crystalColors = { "blue", "green", "purple", "red", "sky", "white", "yellow" };
     std::array<std::weak_ptr<const Texture>, 7UL> albedoCrystals;
     for (size_t textureIdx = 0UL; textureIdx < albedoCrystals.size(); textureIdx++) {
-        albedoCrystals[textureIdx] = textureManager.addTexture(crystalTextureFolder / ("color_map_" + crystalColors[textureIdx] + ".jpg"));
+        albedoCrystals[textureIdx] = textureManager.addMaterialTextureAsync(crystalTextureFolder / ("color_map_" + crystalColors[textureIdx] + ".jpg"), MaterialTextureType::Color, assetLoader, assetBundle);
     }
-    std::weak_ptr<const Texture> aoCrystal              = textureManager.addTexture(crystalTextureFolder / textureAO);
-    std::weak_ptr<const Texture> displacementCrystal    = textureManager.addTexture(crystalTextureFolder / textureDisplacement);
-    std::weak_ptr<const Texture> metalnessCrystal       = textureManager.addTexture(crystalTextureFolder / textureMetalness);
-    std::weak_ptr<const Texture> normalCrystal          = textureManager.addTexture(crystalTextureFolder / textureNormal);
-    std::weak_ptr<const Texture> roughnessCrystal       = textureManager.addTexture(crystalTextureFolder / textureRoughness);
+    std::weak_ptr<const Texture> aoCrystal              = textureManager.addMaterialTextureAsync(crystalTextureFolder / textureAO, MaterialTextureType::Scalar, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> displacementCrystal    = textureManager.addMaterialTextureAsync(crystalTextureFolder / textureDisplacement, MaterialTextureType::Scalar, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> metalnessCrystal       = textureManager.addMaterialTextureAsync(crystalTextureFolder / textureMetalness, MaterialTextureType::Scalar, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> normalCrystal          = textureManager.addMaterialTextureAsync(crystalTextureFolder / textureNormal, MaterialTextureType::Normal, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> roughnessCrystal       = textureManager.addMaterialTextureAsync(crystalTextureFolder / textureRoughness, MaterialTextureType::Scalar, assetLoader, assetBundle);
 
     // Glass
     std::filesystem::path glassTextureFolder        = utils::RESOURCES_DIR_PATH / "textures" / "Glass Blocks";
-    std::weak_ptr<const Texture> albedoGlass        = textureManager.addTexture(glassTextureFolder / textureAlbedo);
-    std::weak_ptr<const Texture> aoGlass            = textureManager.addTexture(glassTextureFolder / textureAO);
-    std::weak_ptr<const Texture> displacementGlass  = textureManager.addTexture(glassTextureFolder / textureDisplacement);
-    std::weak_ptr<const Texture> normalGlass        = textureManager.addTexture(glassTextureFolder / textureNormal);
-    std::weak_ptr<const Texture> roughnessGlass     = textureManager.addTexture(glassTextureFolder / textureRoughness);
+    std::weak_ptr<const Texture> albedoGlass        = textureManager.addMaterialTextureAsync(glassTextureFolder / textureAlbedo, MaterialTextureType::Color, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> aoGlass            = textureManager.addMaterialTextureAsync(glassTextureFolder / textureAO, MaterialTextureType::Scalar, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> displacementGlass  = textureManager.addMaterialTextureAsync(glassTextureFolder / textureDisplacement, MaterialTextureType::Scalar, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> normalGlass        = textureManager.addMaterialTextureAsync(glassTextureFolder / textureNormal, MaterialTextureType::Normal, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> roughnessGlass     = textureManager.addMaterialTextureAsync(glassTextureFolder / textureRoughness, MaterialTextureType::Scalar, assetLoader, assetBundle);
 
     // Stone
     std::filesystem::path stoneTextureFolder        = utils::RESOURCES_DIR_PATH / "textures" / "Mossy Stone";
-    std::weak_ptr<const Texture> albedoStone        = textureManager.addTexture(stoneTextureFolder / textureAlbedo);
-    std::weak_ptr<const Texture> aoStone            = textureManager.addTexture(stoneTextureFolder / textureAO);
-    std::weak_ptr<const Texture> displacementStone  = textureManager.addTexture(stoneTextureFolder / textureDisplacement);
-    std::weak_ptr<const Texture> metalnessStone     = textureManager.addTexture(stoneTextureFolder / textureMetalness);
-    std::weak_ptr<const Texture> normalStone        = textureManager.addTexture(stoneTextureFolder / textureNormal);
-    std::weak_ptr<const Texture> roughnessStone     = textureManager.addTexture(stoneTextureFolder / textureRoughness);
+    std::weak_ptr<const Texture> albedoStone        = textureManager.addMaterialTextureAsync(stoneTextureFolder / textureAlbedo, MaterialTextureType::Color, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> aoStone            = textureManager.addMaterialTextureAsync(stoneTextureFolder / textureAO, MaterialTextureType::Scalar, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> displacementStone  = textureManager.addMaterialTextureAsync(stoneTextureFolder / textureDisplacement, MaterialTextureType::Scalar, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> metalnessStone     = textureManager.addMaterialTextureAsync(stoneTextureFolder / textureMetalness, MaterialTextureType::Scalar, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> normalStone        = textureManager.addMaterialTextureAsync(stoneTextureFolder / textureNormal, MaterialTextureType::Normal, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> roughnessStone     = textureManager.addMaterialTextureAsync(stoneTextureFolder / textureRoughness, MaterialTextureType::Scalar, assetLoader, assetBundle);
 
     // Metal
     std::filesystem::path metalTextureFolder        = utils::RESOURCES_DIR_PATH / "textures" / "Rusty Metal";
-    std::weak_ptr<const Texture> albedoMetal        = textureManager.addTexture(metalTextureFolder / textureAlbedo);
-    std::weak_ptr<const Texture> aoMetal            = textureManager.addTexture(metalTextureFolder / textureAO);
-    std::weak_ptr<const Texture> displacementMetal  = textureManager.addTexture(metalTextureFolder / textureDisplacement);
-    std::weak_ptr<const Texture> metalnessMetal     = textureManager.addTexture(metalTextureFolder / textureMetalness);
-    std::weak_ptr<const Texture> normalMetal        = textureManager.addTexture(metalTextureFolder / textureNormal);
-    std::weak_ptr<const Texture> roughnessMetal     = textureManager.addTexture(metalTextureFolder / textureRoughness);
+    std::weak_ptr<const Texture> albedoMetal        = textureManager.addMaterialTextureAsync(metalTextureFolder / textureAlbedo, MaterialTextureType::Color, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> aoMetal            = textureManager.addMaterialTextureAsync(metalTextureFolder / textureAO, MaterialTextureType::Scalar, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> displacementMetal  = textureManager.addMaterialTextureAsync(metalTextureFolder / textureDisplacement, MaterialTextureType::Scalar, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> metalnessMetal     = textureManager.addMaterialTextureAsync(metalTextureFolder / textureMetalness, MaterialTextureType::Scalar, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> normalMetal        = textureManager.addMaterialTextureAsync(metalTextureFolder / textureNormal, MaterialTextureType::Normal, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> roughnessMetal     = textureManager.addMaterialTextureAsync(metalTextureFolder / textureRoughness, MaterialTextureType::Scalar, assetLoader, assetBundle);
 
     // Fur
     std::filesystem::path furTextureFolder      = utils::RESOURCES_DIR_PATH / "textures" / "Yeti Fur";
     std::array<std::string, 6UL> hyperFurColors = { "blue", "green", "red", "violet", "white", "yellow"};
     std::array<std::weak_ptr<const Texture>, 6UL> albedoHyperFur;
     for (size_t textureIdx = 0UL; textureIdx < albedoHyperFur.size(); textureIdx++) {
-        albedoHyperFur[textureIdx] = textureManager.addTexture(furTextureFolder / ("color_map_" + hyperFurColors[textureIdx] + ".jpg"));
+        albedoHyperFur[textureIdx] = textureManager.addMaterialTextureAsync(furTextureFolder / ("color_map_" + hyperFurColors[textureIdx] + ".jpg"), MaterialTextureType::Color, assetLoader, assetBundle);
     }
-    std::weak_ptr<const Texture> albedoFur          = textureManager.addTexture(furTextureFolder / textureAlbedo);
-    std::weak_ptr<const Texture> aoFur              = textureManager.addTexture(furTextureFolder / textureAO);
-    std::weak_ptr<const Texture> displacementFur    = textureManager.addTexture(furTextureFolder / textureDisplacement);
-    std::weak_ptr<const Texture> normalFur          = textureManager.addTexture(furTextureFolder / textureNormal);
-    std::weak_ptr<const Texture> roughnessFur       = textureManager.addTexture(furTextureFolder / textureRoughness);
+    std::weak_ptr<const Texture> albedoFur          = textureManager.addMaterialTextureAsync(furTextureFolder / textureAlbedo, MaterialTextureType::Color, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> aoFur              = textureManager.addMaterialTextureAsync(furTextureFolder / textureAO, MaterialTextureType::Scalar, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> displacementFur    = textureManager.addMaterialTextureAsync(furTextureFolder / textureDisplacement, MaterialTextureType::Scalar, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> normalFur          = textureManager.addMaterialTextureAsync(furTextureFolder / textureNormal, MaterialTextureType::Normal, assetLoader, assetBundle);
+    std::weak_ptr<const Texture> roughnessFur       = textureManager.addMaterialTextureAsync(furTextureFolder / textureRoughness, MaterialTextureType::Scalar, assetLoader, assetBundle);
     /*************************************/
 
     /********** Model loading and texture setting ************/
     // In-tile objects
-    Mesh apertureCPU    = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "aperture.obj"));
-    Mesh cameraCPU      = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "camera.obj"));
-    Mesh stand1CPU      = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "stand1.obj"));
-    Mesh stand2CPU      = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "stand2.obj"));
-    Mesh suzanneCPU     = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "suzanne.obj"));
-    GPUMesh aperture(apertureCPU);
+    const CookedMesh apertureCooked  = assetLoader.wait(apertureLoad);
+    const CookedMesh cameraCooked    = assetLoader.wait(cameraLoad);
+    const CookedMesh stand1Cooked    = assetLoader.wait(stand1Load);
+    const CookedMesh stand2Cooked    = assetLoader.wait(stand2Load);
+    const CookedMesh suzanneCooked   = assetLoader.wait(suzanneLoad);
+    GPUMesh aperture(apertureCooked);
     aperture.setAlbedo(albedoGlass);
     aperture.setAO(aoGlass);
     aperture.setDisplacement(displacementGlass, true);
     aperture.setNormal(normalGlass);
     aperture.setRoughness(roughnessGlass);
-    GPUMesh camera(cameraCPU);
-    GPUMesh stand1(stand1CPU);
-    GPUMesh stand2(stand2CPU);
+    GPUMesh camera(cameraCooked);
+    GPUMesh stand1(stand1Cooked);
+    GPUMesh stand2(stand2Cooked);
     std::array<GPUMesh*, 3> cameraMetalComponents = { &camera, &stand1, &stand2 };
     for (GPUMesh* component : cameraMetalComponents) {
         component->setAlbedo(albedoMetal);
@@ -306,70 +355,70 @@ int main(int argc, char* argv[]) {
         component->setNormal(normalMetal);
         component->setRoughness(roughnessMetal);
     }
-    GPUMesh suzanne(suzanneCPU);
+    GPUMesh suzanne(suzanneCooked);
     suzanne.setAlbedo(albedoCrystals[3]); // TODO: Link to placement logic so which texture is used is varied
     suzanne.setAO(aoCrystal);
     suzanne.setDisplacement(displacementCrystal, true);
     suzanne.setMetallic(metalnessCrystal);
     suzanne.setNormal(normalCrystal);
     suzanne.setRoughness(roughnessCrystal);
-    HitBox apertureHitBox   = HitBox::makeHitBox(apertureCPU,   false);
-    HitBox cameraHitBox     = HitBox::makeHitBox(cameraCPU,     false);
-    HitBox stand1HitBox     = HitBox::makeHitBox(stand1CPU,     false);
-    HitBox stand2HitBox     = HitBox::makeHitBox(stand2CPU,     false);
-    HitBox suzanneHitbox    = HitBox::makeHitBox(suzanneCPU,    false);
+    HitBox apertureHitBox   = apertureCooked.makeHitBox(false);
+    HitBox cameraHitBox     = cameraCooked.makeHitBox(false);
+    HitBox stand1HitBox     = stand1Cooked.makeHitBox(false);
+    HitBox stand2HitBox     = stand2Cooked.makeHitBox(false);
+    HitBox suzanneHitbox    = suzanneCooked.makeHitBox(false);
 
     // Tile meshes
-    Mesh crossingCPU   = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "crossing.obj"));
-    Mesh roomCPU       = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "room.obj"));
-    Mesh tjunctionCPU  = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "tjunction.obj"));
-    Mesh tunnelCPU     = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "tunnel.obj"));
-    Mesh turnCPU       = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "turn.obj"));
-    GPUMesh crossing(crossingCPU);
-    GPUMesh room(roomCPU);
-    GPUMesh tjunction(tjunctionCPU);
-    GPUMesh tunnel(tunnelCPU);
-    GPUMesh turn(turnCPU);
-    HitBox crossingHitBox   = HitBox::makeHitBox(crossingCPU,   false);
-    HitBox roomHitBox       = HitBox::makeHitBox(roomCPU,       false);
-    HitBox tjunctionHitBox  = HitBox::makeHitBox(tjunctionCPU,  false);
-    HitBox tunnelHitBox     = HitBox::makeHitBox(tunnelCPU,     false);
-    HitBox turnHitbox       = HitBox::makeHitBox(turnCPU,       false);
+    const CookedMesh crossingCooked  = assetLoader.wait(crossingLoad);
+    const CookedMesh roomCooked      = assetLoader.wait(roomLoad);
+    const CookedMesh tjunctionCooked = assetLoader.wait(tjunctionLoad);
+    const CookedMesh tunnelCooked    = assetLoader.wait(tunnelLoad);
+    const CookedMesh turnCooked      = assetLoader.wait(turnLoad);
+    GPUMesh crossing(crossingCooked);
+    GPUMesh room(roomCooked);
+    GPUMesh tjunction(tjunctionCooked);
+    GPUMesh tunnel(tunnelCooked);
+    GPUMesh turn(turnCooked);
+    HitBox crossingHitBox   = crossingCooked.makeHitBox(false);
+    HitBox roomHitBox       = roomCooked.makeHitBox(false);
+    HitBox tjunctionHitBox  = tjunctionCooked.makeHitBox(false);
+    HitBox tunnelHitBox     = tunnelCooked.makeHitBox(false);
+    HitBox turnHitbox       = turnCooked.makeHitBox(false);
 
     // Tile pieces
-    Mesh floorCPU          = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "floor.obj"));
-    Mesh pillarBLCPU       = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "pillar_bottom_left.obj"));
-    Mesh pillarBRCPU       = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "pillar-bottom-right.obj"));
-    Mesh pillarTLCPU       = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "pillar-top-left.obj"));
-    Mesh pillarTRCPU       = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "pillar-top-right.obj"));
-    Mesh wallHRCPU       = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "walf-half-right.obj"));
-    Mesh wallHBCPU       = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "wall-half-bottom.obj"));
-    Mesh wallHTCPU       = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "wall-half-top.obj"));
-    Mesh wallFBCPU       = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "wall-full-bottom.obj"));
-    Mesh wallFRCPU       = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "wall-full-right.obj"));
-    Mesh wallFTCPU       = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "tiles" / "wall-full-top.obj"));    
-    GPUMesh floorT(floorCPU);
-    GPUMesh pillarBL(pillarBLCPU);
-    GPUMesh pillarBR(pillarBRCPU);
-    GPUMesh pillarTL(pillarTLCPU);
-    GPUMesh pillarTR(pillarTRCPU);
-    GPUMesh wallHR(wallHRCPU);
-    GPUMesh wallHB(wallHBCPU);
-    GPUMesh wallHT(wallHTCPU);
-    GPUMesh wallFB(wallFBCPU);
-    GPUMesh wallFR(wallFRCPU);
-    GPUMesh wallFT(wallFTCPU);
-    HitBox floorHitbox          = HitBox::makeHitBox(floorCPU,      false);
-    HitBox pillarBLHitbox       = HitBox::makeHitBox(pillarBLCPU,   true);
-    HitBox pillarBRHitbox       = HitBox::makeHitBox(pillarBRCPU,   true);
-    HitBox pillarTLHitbox       = HitBox::makeHitBox(pillarTLCPU,   true);
-    HitBox pillarTRHitbox       = HitBox::makeHitBox(pillarTRCPU,   true);
-    HitBox wallHRHitbox         = HitBox::makeHitBox(wallHRCPU,     true);
-    HitBox wallHBHitbox         = HitBox::makeHitBox(wallHBCPU,     true);
-    HitBox wallHTHitbox         = HitBox::makeHitBox(wallHTCPU,     true);
-    HitBox wallFBHitbox         = HitBox::makeHitBox(wallFBCPU,     true);
-    HitBox wallFRHitbox         = HitBox::makeHitBox(wallFRCPU,     true);
-    HitBox wallFTHitbox         = HitBox::makeHitBox(wallFTCPU,     true);
+    const CookedMesh floorCooked     = assetLoader.wait(floorLoad);
+    const CookedMesh pillarBLCooked  = assetLoader.wait(pillarBLLoad);
+    const CookedMesh pillarBRCooked  = assetLoader.wait(pillarBRLoad);
+    const CookedMesh pillarTLCooked  = assetLoader.wait(pillarTLLoad);
+    const CookedMesh pillarTRCooked  = assetLoader.wait(pillarTRLoad);
+    const CookedMesh wallHRCooked    = assetLoader.wait(wallHRLoad);
+    const CookedMesh wallHBCooked    = assetLoader.wait(wallHBLoad);
+    const CookedMesh wallHTCooked    = assetLoader.wait(wallHTLoad);
+    const CookedMesh wallFBCooked    = assetLoader.wait(wallFBLoad);
+    const CookedMesh wallFRCooked    = assetLoader.wait(wallFRLoad);
+    const CookedMesh wallFTCooked    = assetLoader.wait(wallFTLoad);
+    GPUMesh floorT(floorCooked);
+    GPUMesh pillarBL(pillarBLCooked);
+    GPUMesh pillarBR(pillarBRCooked);
+    GPUMesh pillarTL(pillarTLCooked);
+    GPUMesh pillarTR(pillarTRCooked);
+    GPUMesh wallHR(wallHRCooked);
+    GPUMesh wallHB(wallHBCooked);
+    GPUMesh wallHT(wallHTCooked);
+    GPUMesh wallFB(wallFBCooked);
+    GPUMesh wallFR(wallFRCooked);
+    GPUMesh wallFT(wallFTCooked);
+    HitBox floorHitbox          = floorCooked.makeHitBox(false);
+    HitBox pillarBLHitbox       = pillarBLCooked.makeHitBox(true);
+    HitBox pillarBRHitbox       = pillarBRCooked.makeHitBox(true);
+    HitBox pillarTLHitbox       = pillarTLCooked.makeHitBox(true);
+    HitBox pillarTRHitbox       = pillarTRCooked.makeHitBox(true);
+    HitBox wallHRHitbox         = wallHRCooked.makeHitBox(true);
+    HitBox wallHBHitbox         = wallHBCooked.makeHitBox(true);
+    HitBox wallHTHitbox         = wallHTCooked.makeHitBox(true);
+    HitBox wallFBHitbox         = wallFBCooked.makeHitBox(true);
+    HitBox wallFRHitbox         = wallFRCooked.makeHitBox(true);
+    HitBox wallFTHitbox         = wallFTCooked.makeHitBox(true);
 
     // Set textures for all tile components
     std::array<GPUMesh*, 16UL> tileMeshes = { &crossing, &room, &tjunction, &tunnel, &turn, &floorT, &pillarBL, &pillarBR,
@@ -383,32 +432,23 @@ int main(int argc, char* argv[]) {
         mesh->setRoughness(roughnessStone);
     }
 
-    // Player character
-    Mesh defaultMonkeyModel = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "animated" / "monkeypose0.obj"));
-    std::vector<GPUMesh> monkeyPoses;
-    std::vector<HitBox> monkeyHitBoxes;
-    monkeyPoses.emplace_back(defaultMonkeyModel);
-    monkeyHitBoxes.push_back(HitBox::makeHitBox(defaultMonkeyModel, true));
-    for (size_t i = 0UL; i < 16UL; i++) {
-        // Load model and create mesh and hitbox objects
-        if (i != 0UL) {
-            auto fileName   = "monkeypose" + std::to_string(i * 2)+ ".obj";
-            Mesh cpuMesh    = mergeMeshes(loadMesh(utils::RESOURCES_DIR_PATH / "models" / "animated" / fileName));
-            monkeyPoses.emplace_back(cpuMesh);
-            monkeyHitBoxes.push_back(HitBox::makeHitBox(cpuMesh, true));
-        }
-        
-        // Link textures
-        monkeyPoses[i].setAlbedo(albedoFur);
-        monkeyPoses[i].setAO(aoFur);
-        monkeyPoses[i].setDisplacement(displacementFur, true);
-        monkeyPoses[i].setNormal(normalFur);
-        monkeyPoses[i].setRoughness(roughnessFur);
-    }
+    // Player character (walk cycle poses are blended in the vertex shader)
+    const CookedMorphMesh monkeyCooked = assetLoader.wait(monkeyLoad);
+    GPUMesh monkeyMesh(monkeyCooked);
+    const HitBox monkeyHitBox = monkeyCooked.makeHitBox(true);
+    monkeyMesh.setAlbedo(albedoFur);
+    monkeyMesh.setAO(aoFur);
+    monkeyMesh.setDisplacement(displacementFur, true);
+    monkeyMesh.setNormal(normalFur);
+    monkeyMesh.setRoughness(roughnessFur);
+
+    // Textures must all be uploaded before the material arrays are built from them
+    assetLoader.finish();
+    assetBundle.save();
     /**************************************/
 
     // Add player mesh node
-    MeshTree* player = new MeshTree("player", monkeyHitBoxes[0], &monkeyPoses[0], playerPos,
+    MeshTree* player = new MeshTree("player", monkeyHitBox, &monkeyMesh, playerPos,
                                     glm::vec4(0.0f, 1.0f, 0.0f, 180.0f),
                                     glm::vec4(0.0f, 1.0f, 0.0f, 0.0f),
                                     glm::vec3(0.3f));
@@ -444,7 +484,6 @@ int main(int argc, char* argv[]) {
     std::chrono::high_resolution_clock timer; 
     BezierCurve<glm::vec3> b3d                      = BezierCurve<glm::vec3>(glm::vec3(0.f), glm::vec3(1.f , 1.f, 0.f), glm::vec3(-1.f , 2.f, 0.f), glm::vec3(0.f, 3.f, 0.f), 10.f);
     BezierCurve<glm::vec3> b3d2                     = BezierCurve<glm::vec3>(glm::vec3(0.f, 3.f, 0.f), glm::vec3(-1.f , 2.f, 0.f), glm::vec3(1.f , 1.f, 0.f), glm::vec3(0.f), 10.f);
-    BezierCurve<glm::vec4> b4d                      = BezierCurve<glm::vec4>(glm::vec4(0.f, 0.f, 0.f, 1.f), glm::vec4(0.f , 0.3826834f, 0.f, 0.9238795f), glm::vec4(0.f , 0.7132504f, 0.f, 0.7009093f), glm::vec4(0.f , 1.f, 0.f, 0.f), 10.f);
     BezierComposite<glm::vec3> b3c                  = BezierComposite<glm::vec3>({b3d, b3d2}, true, 20.f);
     std::chrono::time_point millisec_since_epoch    = timer.now();
     BezierCurveManager bezierCurveManager           = BezierCurveManager(millisec_since_epoch);
@@ -455,6 +494,10 @@ int main(int argc, char* argv[]) {
     playerLastDetected                      = millisec_since_epoch;
     glm::vec3 prev_pos                      = playerPos;
 
+    // Simulation clock (camera sweeps, particles and the walk cycle advance in fixed steps, independent of the frame rate)
+    utils::FixedTimestep simulationClock(utils::SIMULATION_TIMESTEP, utils::MAX_SIMULATION_STEPS_PER_FRAME);
+    std::chrono::time_point prev_frame      = millisec_since_epoch;
+
     // Create root node of board
     boardRoot = new MeshTree("boardoot", std::nullopt);
     MemoryManager::addEl(boardRoot);
@@ -506,7 +549,7 @@ int main(int argc, char* argv[]) {
             inCutscene = true;
         }
         if (inCutscene) {
-            monkeyPoses[0].setAlbedo(albedoHyperFur[seizureCounter]);
+            monkeyMesh.setAlbedo(albedoHyperFur[seizureCounter]);
             if (++seizureSubCounter >= utils::SEIZURE_SUB_LIMIT) {
                 seizureSubCounter   = 0UL;
                 seizureCounter      = (seizureCounter + 1UL) % albedoHyperFur.size();
@@ -547,6 +590,7 @@ int main(int argc, char* argv[]) {
                 int32_t tileX = static_cast<int32_t>(floor((playerPos.z - offsetBoard.z) / utils::TILE_LENGTH_X));
                 int32_t tileY = static_cast<int32_t>(floor((playerPos.x - offsetBoard.x) / utils::TILE_LENGTH_Z));
                 std::cout << tileX << " " << tileY << std::endl;
+                headMesh->removeAnimations(bezierCurveManager);
                 MemoryManager::removeEl(headMesh);
                 dir = 100 + tileY * 10 + tileX;
                 signalChange();
@@ -556,9 +600,15 @@ int main(int argc, char* argv[]) {
         }
         Camera& currentCamera = renderConfig.controlPlayer ? playerCamera : mainCamera;
         std::chrono::time_point curr_frame = timer.now();
-        bezierCurveManager.timeStep(curr_frame);
-        makeCameraMoves(playerPos, curr_frame);
-        float delta = std::chrono::duration<float>(curr_frame - millisec_since_epoch).count();
+        bezierCurveManager.timeStep(curr_frame, jobSystem);
+
+        // Run as many simulation steps as real time has passed, then draw the state interpolated between the last two of them
+        const uint32_t simulationSteps  = simulationClock.advance(std::chrono::duration<float>(curr_frame - prev_frame).count());
+        const float interpolation       = simulationClock.interpolation();
+        prev_frame                      = curr_frame;
+        for (uint32_t step = 0U; step < simulationSteps; step++) { makeCameraMoves(playerPos, curr_frame); }
+        for (const std::weak_ptr<EnemyCamera>& enemyCamera : cameras) { if (!enemyCamera.expired()) { enemyCamera.lock()->interpolateSweep(interpolation); } }
+        float delta = simulationClock.renderTime();
         int rem = static_cast<int>(floor(delta / 0.4f));
         float pos = delta - 0.4f*rem;
         if(motion){
@@ -566,22 +616,22 @@ int main(int argc, char* argv[]) {
             if(pos > 0.2f){
                 pos = pos - 0.2f;
                 pos = 15.f*pos/0.2f;
-                player->mesh = &monkeyPoses[15 - static_cast<int>(floor(pos))];
+                monkeyMesh.setPose(15.f - pos);
             }else{
                 pos = 15.f*pos/0.2f;
-                player->mesh = &monkeyPoses[static_cast<int>(floor(pos))];
+                monkeyMesh.setPose(pos);
                 
             }
             prev_motion = motion;
             motion = false;
         }else{
-            player->mesh = &monkeyPoses[0];
+            monkeyMesh.setPose(0.f);
         }
 
         if(fabs(playerPos.z - prev_pos.z) >= 2.0f * utils::TILE_LENGTH_Z){
             if(playerPos.z < prev_pos.z){
                 dir = 4;
-                b->shiftLeft(lightManager, particleEmitterManager);
+                b->shiftLeft(lightManager, particleEmitterManager, bezierCurveManager);
                 MemoryManager::removeEl(boardRoot);
             
                 boardRoot = new MeshTree("boardroot", std::nullopt);
@@ -610,7 +660,7 @@ int main(int argc, char* argv[]) {
                 
             }else{
                 dir = 2;
-                b->shiftRight(lightManager, particleEmitterManager);
+                b->shiftRight(lightManager, particleEmitterManager, bezierCurveManager);
                 MemoryManager::removeEl(boardRoot);
             
                 boardRoot = new MeshTree("boardroot", std::nullopt);
@@ -637,7 +687,7 @@ int main(int argc, char* argv[]) {
             if(playerPos.x > prev_pos.x){
                 std::cout<<"down"<<std::endl;
                 dir = 3;
-                b->shiftDown(lightManager, particleEmitterManager);
+                b->shiftDown(lightManager, particleEmitterManager, bezierCurveManager);
                 MemoryManager::removeEl(boardRoot);
             
                 boardRoot = new MeshTree("boardroot", std::nullopt);
@@ -666,7 +716,7 @@ int main(int argc, char* argv[]) {
                 
             }else{
                 dir = 1;
-                b->shiftUp(lightManager, particleEmitterManager);
+                b->shiftUp(lightManager, particleEmitterManager, bezierCurveManager);
                 MemoryManager::removeEl(boardRoot);
             
                 boardRoot = new MeshTree("boardroot", std::nullopt);
@@ -702,14 +752,15 @@ int main(int argc, char* argv[]) {
         }
 
         // Update transformation of managed mesh tree objects
-        scene.root->transformExternal();
+        scene.root->transformExternal(jobSystem);
 
         // View and projection matrices setup
         const float fovRadians              = glm::radians(cameraZoomed ? renderConfig.zoomedVerticalFOV : renderConfig.verticalFOV);
         const glm::mat4 m_viewProjection    = glm::perspective(fovRadians, utils::ASPECT_RATIO, 0.1f, 30.0f) * currentCamera.viewMatrix();
 
         // Particle simulation
-        particleEmitterManager.updateEmitters();
+        for (uint32_t step = 0U; step < simulationSteps; step++) { particleEmitterManager.updateEmitters(m_viewProjection, currentCamera.cameraPos(), jobSystem); }
+        particleEmitterManager.setInterpolation(interpolation);
         player->modelMatrix();
         // Render shadow maps
         utils::renderShadowMaps(scene.root, renderConfig, lightManager);
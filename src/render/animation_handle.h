@@ -0,0 +1,13 @@
+#ifndef _ANIMATION_HANDLE_H_
+#define _ANIMATION_HANDLE_H_
+
+#include <stdint.h>
+
+// Identifies a track of BezierCurveManager. The generation is bumped whenever a slot is freed, so handles to removed tracks stay
+// harmless even once their slot is reused
+struct AnimationHandle {
+    uint32_t slot;
+    uint32_t generation;
+};
+
+#endif
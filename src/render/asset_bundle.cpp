@@ -0,0 +1,160 @@
+#include "asset_bundle.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <fmt/format.h>
+DISABLE_WARNINGS_POP()
+
+#include <utils/constants.h>
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// Bump whenever the file layout changes. Changes to the cooked formats themselves are caught by the loaders, which validate
+// the bundled bytes exactly like loose cache files
+static constexpr uint32_t ASSET_BUNDLE_MAGIC    = 0x444E424D; // "MBND"
+static constexpr uint32_t ASSET_BUNDLE_VERSION  = 2U;
+
+// Every asset starts on a 16-byte boundary so cooked headers and the arrays following them are aligned in the mapping
+static constexpr size_t ASSET_BUNDLE_ALIGNMENT = 16UL;
+static size_t alignOffset(size_t offset) { return (offset + ASSET_BUNDLE_ALIGNMENT - 1UL) & ~(ASSET_BUNDLE_ALIGNMENT - 1UL); }
+
+AssetBundle::AssetBundle(std::filesystem::path bundlePath)
+    : m_bundlePath(std::move(bundlePath)) {
+    if (!std::filesystem::exists(m_bundlePath)) { return; }
+
+    // A bad bundle only costs load time, since every asset can still be loaded from the loose cache
+    std::shared_ptr<MappedFile> mapping;
+    try { mapping = std::make_shared<MappedFile>(m_bundlePath); }
+    catch (const MappedFileException& exception) {
+        std::cerr << exception.what() << std::endl;
+        return;
+    }
+    if (mapping->size() < sizeof(BundleHeader)) { return; }
+    const BundleHeader& header = *reinterpret_cast<const BundleHeader*>(mapping->bytes().data());
+    if (header.magic != ASSET_BUNDLE_MAGIC || header.version != ASSET_BUNDLE_VERSION ||
+        mapping->size() < sizeof(BundleHeader) + header.numEntries * sizeof(IndexEntry)) {
+        std::cerr << fmt::format("Ignoring invalid asset bundle {}", m_bundlePath.string()) << std::endl;
+        return;
+    }
+
+    // Assets are requested in roughly the order they were bundled, so read the whole file ahead rather than faulting it in piecemeal
+    mapping->prefetch();
+    m_index     = { reinterpret_cast<const IndexEntry*>(mapping->bytes().data() + sizeof(BundleHeader)), static_cast<size_t>(header.numEntries) };
+    m_mapping   = std::move(mapping);
+}
+
+std::optional<BundledAsset> AssetBundle::find(std::span<const std::filesystem::path> sourcePaths, AssetFormat format) {
+    // Index is sorted by (path hash, format)
+    const EntryKey key  = { pathHash(sourcePaths), static_cast<uint32_t>(format) };
+    auto entryIter      = std::lower_bound(m_index.begin(), m_index.end(), key, [](const IndexEntry& entry, const EntryKey& searchKey) {
+        return EntryKey(entry.pathHash, entry.format) < searchKey;
+    });
+    if (entryIter == m_index.end() || EntryKey(entryIter->pathHash, entryIter->format) != key) { return std::nullopt; }
+    if (entryIter->offset > m_mapping->size() || entryIter->size > m_mapping->size() - entryIter->offset) { return std::nullopt; }
+
+    // A bundle may ship without the loose source files, so only sources which exist and were edited invalidate an entry
+    const SourceStamp stamp = stampSources(sourcePaths);
+    if (stamp.exists && (stamp.size != entryIter->sourceSize || stamp.writeTime != entryIter->sourceWriteTime)) { return std::nullopt; }
+
+    const BundledAsset asset = { m_mapping, m_mapping->bytes().subspan(entryIter->offset, entryIter->size) };
+    std::lock_guard lock(mutex);
+    usedAssets.insert_or_assign(key, UsedAsset { asset, { entryIter->sourceSize, entryIter->sourceWriteTime, true } });
+    return asset;
+}
+
+void AssetBundle::add(std::span<const std::filesystem::path> sourcePaths, AssetFormat format, BundledAsset asset) {
+    const EntryKey key      = { pathHash(sourcePaths), static_cast<uint32_t>(format) };
+    const SourceStamp stamp = stampSources(sourcePaths);
+    std::lock_guard lock(mutex);
+    usedAssets.insert_or_assign(key, UsedAsset { std::move(asset), stamp });
+    outdated = true;
+}
+
+void AssetBundle::save() {
+    std::lock_guard lock(mutex);
+    if (!outdated) { return; }
+
+    // Lay out the index (already sorted, since the map orders by key) followed by the data
+    BundleHeader header {};
+    header.magic        = ASSET_BUNDLE_MAGIC;
+    header.version      = ASSET_BUNDLE_VERSION;
+    header.numEntries   = usedAssets.size();
+    std::vector<IndexEntry> index;
+    index.reserve(usedAssets.size());
+    size_t offset = alignOffset(sizeof(BundleHeader) + usedAssets.size() * sizeof(IndexEntry));
+    for (const auto& [key, usedAsset] : usedAssets) {
+        IndexEntry entry {};
+        entry.pathHash          = key.first;
+        entry.format            = key.second;
+        entry.offset            = offset;
+        entry.size              = usedAsset.asset.bytes.size();
+        entry.sourceSize        = usedAsset.stamp.size;
+        entry.sourceWriteTime   = usedAsset.stamp.writeTime;
+        index.push_back(entry);
+        offset = alignOffset(offset + entry.size);
+    }
+
+    // Written next to the bundle and swapped in so an interrupted write never leaves a truncated bundle behind. The current bundle
+    // stays mapped (cooked textures keep streaming from it), which Windows does not allow replacing; the new bundle is then only
+    // picked up once the old one is no longer in use
+    const std::filesystem::path tempPath = m_bundlePath.string() + ".tmp";
+    try {
+        std::filesystem::create_directories(m_bundlePath.parent_path());
+        {
+            constexpr std::array<char, ASSET_BUNDLE_ALIGNMENT> zeroes {};
+            std::ofstream output(tempPath, std::ios::binary | std::ios::trunc);
+            output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            output.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(IndexEntry)));
+            size_t writtenBytes = sizeof(BundleHeader) + index.size() * sizeof(IndexEntry);
+            auto entryIter      = index.begin();
+            for (const auto& [key, usedAsset] : usedAssets) {
+                output.write(zeroes.data(), static_cast<std::streamsize>(entryIter->offset - writtenBytes));
+                output.write(reinterpret_cast<const char*>(usedAsset.asset.bytes.data()), static_cast<std::streamsize>(entryIter->size));
+                writtenBytes = entryIter->offset + entryIter->size;
+                entryIter++;
+            }
+            if (!output) { throw std::filesystem::filesystem_error("Failed to write asset bundle", tempPath, std::make_error_code(std::errc::io_error)); }
+        }
+        std::filesystem::rename(tempPath, m_bundlePath);
+        std::cout << fmt::format("Bundled {} assets into {}\n", index.size(), m_bundlePath.filename().string()) << std::flush;
+    } catch (const std::filesystem::filesystem_error& error) {
+        std::cerr << fmt::format("Could not save asset bundle: {}", error.what()) << std::endl;
+    }
+    outdated = false;
+}
+
+uint64_t AssetBundle::pathHash(std::span<const std::filesystem::path> sourcePaths) {
+    // Hash paths relative to the resources folder so the bundle still matches if the project is moved
+    const std::filesystem::path resourcesPath   = utils::RESOURCES_DIR_PATH.lexically_normal();
+    uint64_t hash                               = utils::fnv1a64({});
+    for (const std::filesystem::path& sourcePath : sourcePaths) {
+        const std::filesystem::path normalPath      = sourcePath.lexically_normal();
+        const std::filesystem::path relativePath    = normalPath.lexically_relative(resourcesPath);
+        const std::string key                       = (relativePath.empty() ? normalPath : relativePath).generic_string() + '\n';
+        hash                                        = utils::fnv1a64(std::as_bytes(std::span(key.data(), key.size())), hash);
+    }
+    return hash;
+}
+
+AssetBundle::SourceStamp AssetBundle::stampSources(std::span<const std::filesystem::path> sourcePaths) {
+    SourceStamp stamp;
+    uint64_t writeTimeHash = utils::fnv1a64({});
+    for (const std::filesystem::path& sourcePath : sourcePaths) {
+        std::error_code sizeError, timeError;
+        const uintmax_t size                            = std::filesystem::file_size(sourcePath, sizeError);
+        const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(sourcePath, timeError);
+        if (sizeError || timeError) { return {}; }
+
+        const int64_t writeTimeCount    = static_cast<int64_t>(writeTime.time_since_epoch().count());
+        stamp.size                      += static_cast<uint64_t>(size);
+        writeTimeHash                   = utils::fnv1a64(std::as_bytes(std::span(&writeTimeCount, 1UL)), writeTimeHash);
+    }
+    stamp.writeTime = static_cast<int64_t>(writeTimeHash);
+    stamp.exists    = true;
+    return stamp;
+}
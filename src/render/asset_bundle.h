@@ -0,0 +1,90 @@
+#ifndef _ASSET_BUNDLE_H_
+#define _ASSET_BUNDLE_H_
+
+#include <utils/mapped_file.hpp>
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdint.h>
+#include <utility>
+
+// Kind of cooked data stored for a source file (the same image may be cooked as several texture types)
+enum class AssetFormat : uint32_t {
+    Mesh            = 0U,
+    ColorTexture    = 1U,
+    NormalTexture   = 2U,
+    ScalarTexture   = 3U,
+    MorphMesh       = 4U    // Cooked from several source files (one per pose)
+};
+
+// Cooked asset bytes along with the mapping keeping them alive
+struct BundledAsset {
+    std::shared_ptr<const MappedFile> file;
+    std::span<const std::byte> bytes;
+};
+
+// Every cooked asset the game loads, packed into a single file with a sorted index (source path hash to offset, size, and format)
+// at the front. The bundle is mapped once and read front to back, so startup is one sequential read instead of opening, hashing,
+// and mapping a source file and a cache file per asset. Loaders fall back to the loose cache (resources/cache) for assets missing
+// from the bundle or whose source file changed since it was bundled; save() then repacks the bundle with every asset used this run
+class AssetBundle {
+public:
+    AssetBundle(std::filesystem::path bundlePath);
+
+    // Thread-safe. Assets cooked from several files are identified (and invalidated) by all of them
+    std::optional<BundledAsset> find(std::span<const std::filesystem::path> sourcePaths, AssetFormat format);
+    void add(std::span<const std::filesystem::path> sourcePaths, AssetFormat format, BundledAsset asset);
+    std::optional<BundledAsset> find(const std::filesystem::path& sourcePath, AssetFormat format)       { return find({ &sourcePath, 1UL }, format); }
+    void add(const std::filesystem::path& sourcePath, AssetFormat format, BundledAsset asset)           { add({ &sourcePath, 1UL }, format, std::move(asset)); }
+
+    // Rewrites the bundle if any asset had to be loaded from outside it. Call once all assets are loaded
+    void save();
+
+private:
+    struct BundleHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t numEntries;
+    };
+
+    struct IndexEntry {
+        uint64_t pathHash;
+        uint32_t format;
+        uint32_t padding;
+        uint64_t offset;            // From the start of the file
+        uint64_t size;
+        uint64_t sourceSize;        // Total size and hash of the modification times of the source files when the asset was bundled,
+        int64_t sourceWriteTime;    // used to detect edits without reading the sources
+    };
+
+    struct SourceStamp {
+        uint64_t size       { 0UL };
+        int64_t writeTime   { 0L };
+        bool exists         { false };
+    };
+
+    // Assets used this run, which is exactly what the next bundle will contain
+    struct UsedAsset {
+        BundledAsset asset;
+        SourceStamp stamp;
+    };
+
+    using EntryKey = std::pair<uint64_t, uint32_t>;
+
+    static uint64_t pathHash(std::span<const std::filesystem::path> sourcePaths);
+    static SourceStamp stampSources(std::span<const std::filesystem::path> sourcePaths);
+
+    std::filesystem::path m_bundlePath;
+    std::shared_ptr<const MappedFile> m_mapping;
+    std::span<const IndexEntry> m_index;
+
+    std::mutex mutex;
+    std::map<EntryKey, UsedAsset> usedAssets;
+    bool outdated { false };
+};
+
+#endif
@@ -0,0 +1,115 @@
+#include "asset_loader.h"
+
+#include <algorithm>
+#include <utility>
+
+AssetLoader::AssetLoader(size_t maxPendingUploads, size_t numWorkers)
+    : maxPendingUploads(std::max<size_t>(maxPendingUploads, 1)) {
+    for (size_t workerIdx = 0UL; workerIdx < numWorkers; workerIdx++) { workers.emplace_back(&AssetLoader::workerLoop, this); }
+}
+
+AssetLoader::~AssetLoader() {
+    {
+        std::scoped_lock lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+    uploadSpace.notify_all();
+    for (std::thread& worker : workers) { worker.join(); }
+}
+
+size_t AssetLoader::defaultNumWorkers() {
+    // Leave one core for the main thread, which is busy issuing the uploads
+    const size_t numCores = std::thread::hardware_concurrency();
+    return numCores > 1UL ? numCores - 1UL : 1UL;
+}
+
+void AssetLoader::submitDetached(std::function<void()> job) {
+    enqueueJob([this, job = std::move(job)]() {
+        try { job(); }
+        catch (...) {
+            std::scoped_lock lock(mutex);
+            if (!firstDetachedError) { firstDetachedError = std::current_exception(); }
+        }
+    });
+}
+
+void AssetLoader::enqueueUpload(std::function<void()> upload) {
+    {
+        std::unique_lock lock(mutex);
+        uploadSpace.wait(lock, [this]() { return uploads.size() < maxPendingUploads || stopping; });
+        if (stopping) { return; }
+        uploads.push_back(std::move(upload));
+        progressEpoch++;
+    }
+    progress.notify_all();
+}
+
+size_t AssetLoader::drainUploads() {
+    // Take the whole queue at once so that workers can refill it while the uploads run
+    std::deque<std::function<void()>> pendingUploads;
+    {
+        std::scoped_lock lock(mutex);
+        pendingUploads.swap(uploads);
+    }
+    uploadSpace.notify_all();
+
+    for (const std::function<void()>& upload : pendingUploads) { upload(); }
+    return pendingUploads.size();
+}
+
+void AssetLoader::finish() {
+    while (true) {
+        const uint64_t epoch = currentEpoch();
+        drainUploads();
+        {
+            std::scoped_lock lock(mutex);
+            if (numUnfinishedJobs == 0UL && uploads.empty()) {
+                if (firstDetachedError) { std::rethrow_exception(std::exchange(firstDetachedError, nullptr)); }
+                return;
+            }
+        }
+        waitForProgress(epoch);
+    }
+}
+
+void AssetLoader::workerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock lock(mutex);
+            jobAvailable.wait(lock, [this]() { return !jobs.empty() || stopping; });
+            if (stopping) { return; }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        job();
+
+        {
+            std::scoped_lock lock(mutex);
+            numUnfinishedJobs--;
+            progressEpoch++;
+        }
+        progress.notify_all();
+    }
+}
+
+void AssetLoader::enqueueJob(std::function<void()> job) {
+    {
+        std::scoped_lock lock(mutex);
+        jobs.push_back(std::move(job));
+        numUnfinishedJobs++;
+    }
+    jobAvailable.notify_one();
+}
+
+uint64_t AssetLoader::currentEpoch() {
+    std::scoped_lock lock(mutex);
+    return progressEpoch;
+}
+
+void AssetLoader::waitForProgress(uint64_t epoch) {
+    std::unique_lock lock(mutex);
+    progress.wait(lock, [this, epoch]() { return progressEpoch != epoch || !uploads.empty(); });
+}
@@ -0,0 +1,84 @@
+#ifndef _ASSET_LOADER_H_
+#define _ASSET_LOADER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Runs CPU-side asset work (image decoding, mesh parsing and cooking) on a pool of worker threads. Anything touching OpenGL
+// must happen on the thread owning the context, so workers hand GL work back through a bounded upload queue which the main
+// thread drains. The bound caps how many decoded-but-not-uploaded assets can sit in memory at once; workers block when it is full
+class AssetLoader {
+public:
+    AssetLoader(size_t maxPendingUploads, size_t numWorkers = defaultNumWorkers());
+    AssetLoader(const AssetLoader&) = delete;
+    ~AssetLoader();
+
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // Worker side
+    template <typename Job>
+    std::future<std::invoke_result_t<Job>> submit(Job&& job);
+    void submitDetached(std::function<void()> job); // Exceptions are rethrown by finish()
+    void enqueueUpload(std::function<void()> upload);
+
+    // Main (GL) thread side
+    size_t drainUploads();
+    template <typename T>
+    T wait(std::future<T>& future);
+    void finish();
+
+    static size_t defaultNumWorkers();
+
+private:
+    void workerLoop();
+    void enqueueJob(std::function<void()> job);
+    uint64_t currentEpoch();
+    void waitForProgress(uint64_t epoch);
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::deque<std::function<void()>> uploads;
+    size_t maxPendingUploads;
+    size_t numUnfinishedJobs { 0UL };
+    uint64_t progressEpoch { 0UL }; // Bumped whenever an upload is queued or a job finishes
+    std::exception_ptr firstDetachedError;
+    bool stopping { false };
+
+    std::mutex mutex;
+    std::condition_variable jobAvailable;   // Workers wait on this for new jobs
+    std::condition_variable uploadSpace;    // Workers wait on this for room in the upload queue
+    std::condition_variable progress;       // Main thread waits on this for new uploads or finished jobs
+};
+
+template <typename Job>
+std::future<std::invoke_result_t<Job>> AssetLoader::submit(Job&& job) {
+    // Packaged tasks are move-only, so share ownership to fit in a (copyable) std::function
+    using Result = std::invoke_result_t<Job>;
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Job>(job));
+    std::future<Result> future = task->get_future();
+    enqueueJob([task]() { (*task)(); });
+    return future;
+}
+
+template <typename T>
+T AssetLoader::wait(std::future<T>& future) {
+    // Keep draining uploads while waiting, otherwise workers blocked on a full upload queue could never finish the job
+    while (true) {
+        const uint64_t epoch = currentEpoch();
+        drainUploads();
+        if (future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) { return future.get(); }
+        waitForProgress(epoch);
+    }
+}
+
+#endif
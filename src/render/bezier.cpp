@@ -1,97 +1,348 @@
 #include "bezier.h"
 
-#include <utils/misc_utils.hpp>
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/geometric.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <utils/simd.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+
+template<typename Type>
+BezierCurve<Type>::BezierCurve(Type p1t, Type p2t, Type p3t, Type p4t, float total_timet)
+    : totalTime(total_timet)
+    , controlP0(p1t), controlP1(p2t), controlP2(p3t), controlP3(p4t)
+    , coefficients { controlP0,
+                     3.0f * (controlP1 - controlP0),
+                     3.0f * (controlP0 - 2.0f * controlP1 + controlP2),
+                     controlP3 - controlP0 + 3.0f * (controlP1 - controlP2) } {}
 
 template<typename Type>
-Type BezierCurve<Type>::positionAtTime(float t) {
+Type BezierCurve<Type>::positionAtTime(float t) const {
     if (t < 0)          { return controlP0; }
     if (t > totalTime)  { return controlP3; }
-    t /= totalTime;
-    return  1.0f *   float(pow(1.0f - t, 3.0f)) * 1.0f          * controlP0 +
-            3.0f *   float(pow(1.0f - t, 2.0f)) * t             * controlP1 +
-            3.0f *   (1.0f - t)          * float(pow(t, 2.0f))  * controlP2 +
-            1.0f *   1.0f                * float(pow(t, 3.0f))  * controlP3;
+    const float u = t / totalTime;
+    return ((coefficients[3] * u + coefficients[2]) * u + coefficients[1]) * u + coefficients[0];
 }
 
 template<typename Type>
-Type BezierComposite<Type>::positionAtTime(float t) {
-    if (loop) {
-        int32_t integerComponent    = static_cast<int32_t>(floor(t / total));
-        t                           -= total * integerComponent;
+std::vector<float> BezierCurve<Type>::arcLengthTable(uint32_t numSamples) const {
+    numSamples = std::max(numSamples, 2U);
+    std::vector<float> arcLengths(numSamples, 0.0f);
+    Type previousPosition = controlP0;
+    for (uint32_t sampleIdx = 1U; sampleIdx < numSamples; sampleIdx++) {
+        const Type position     = positionAtTime(totalTime * static_cast<float>(sampleIdx) / static_cast<float>(numSamples - 1U));
+        arcLengths[sampleIdx]   = arcLengths[sampleIdx - 1U] + glm::length(position - previousPosition);
+        previousPosition        = position;
     }
-    
-    if (t < 0.0f)   { m_curves.front().controlP0; }
-    if (t > total)  { m_curves.back().controlP3; }
-    
-    for (BezierCurve<Type>& curve : m_curves){
-        if (t - curve.totalTime < 0.0f) { return curve.positionAtTime(t); }
-        t -= curve.totalTime;
+
+    // A curve collapsed onto a point has no length to distribute, keep its parametrisation
+    const float totalLength = arcLengths.back();
+    for (uint32_t sampleIdx = 0U; sampleIdx < numSamples; sampleIdx++) {
+        arcLengths[sampleIdx] = totalLength > 0.0f ? arcLengths[sampleIdx] / totalLength : static_cast<float>(sampleIdx) / static_cast<float>(numSamples - 1U);
     }
-    return Type { 0.0f };
+    arcLengths.back() = 1.0f;
+    return arcLengths;
 }
 
-// Needed for quaternion-to-angles conversion (I REALLY can't be assed to figure out how to re-use the general template)
-template<>
-bool BezierCombo<glm::vec4>::positionAtTime(float t) {
-    if (obj.expired()) { return false; }
-    glm::vec4 ret   = curve.positionAtTime(t);
-    *toMove         = utils::quaternionToAxisAndDegrees(ret);
-    return true;
+template<typename Type>
+float BezierCurve<Type>::parameterAtArcLength(std::span<const float> arcLengths, float lengthFraction) {
+    if (arcLengths.size() < 2UL) { return lengthFraction; }
+
+    // Searching the inner entries only keeps the interval in range
+    const auto nextIter         = std::upper_bound(arcLengths.begin() + 1, arcLengths.end() - 1, lengthFraction);
+    const size_t sampleIdx      = static_cast<size_t>(std::distance(arcLengths.begin(), nextIter)) - 1UL;
+    const float intervalLength  = arcLengths[sampleIdx + 1UL] - arcLengths[sampleIdx];
+    const float intervalOffset  = intervalLength > 0.0f ? std::clamp((lengthFraction - arcLengths[sampleIdx]) / intervalLength, 0.0f, 1.0f) : 0.0f;
+    return (static_cast<float>(sampleIdx) + intervalOffset) / static_cast<float>(arcLengths.size() - 1UL);
 }
 
 template<typename Type>
-bool BezierCombo<Type>::positionAtTime(float t) {
-    if (obj.expired()) { return false; }
-    Type ret    = curve.positionAtTime(t);
-    *toMove     = ret;
-    return true;
+BezierComposite<Type>::BezierComposite(const std::vector<BezierCurve<Type>>& curves, bool toLoop, float completeTime)
+    : total(completeTime)
+    , loop(toLoop)
+    , m_curves(curves) {
+    float segmentEnd = 0.0f;
+    m_segmentEnds.reserve(m_curves.size());
+    for (const BezierCurve<Type>& curve : m_curves) {
+        segmentEnd += curve.totalTime;
+        m_segmentEnds.push_back(segmentEnd);
+    }
 }
 
-template<>
-bool BezierComboComposite<glm::vec4>::positionAtTime(float t) {
-    if (obj.expired()) { return false; }
-    glm::vec4 ret   = curve.positionAtTime(t);
-    *toMove         = utils::quaternionToAxisAndDegrees(ret);
-    return true;
+template<typename Type>
+Type BezierComposite<Type>::positionAtTime(float t) const {
+    if (m_curves.empty()) { return Type { 0.0f }; }
+    if (loop && total > 0.0f) { t -= total * std::floor(t / total); }
+
+    if (t < 0.0f)                   { return m_curves.front().controlP0; }
+    if (t >= m_segmentEnds.back())  { return m_curves.back().controlP3; }
+
+    const size_t curveIdx   = static_cast<size_t>(std::distance(m_segmentEnds.begin(), std::upper_bound(m_segmentEnds.begin(), m_segmentEnds.end(), t)));
+    const float curveStart  = curveIdx == 0UL ? 0.0f : m_segmentEnds[curveIdx - 1UL];
+    return m_curves[curveIdx].positionAtTime(t - curveStart);
 }
 
-template<typename Type>
-bool BezierComboComposite<Type>::positionAtTime(float t) {
-    if (obj.expired()) { return false; }
-    Type ret    = curve.positionAtTime(t);
-    *toMove     = ret;
-    return true;
+template class BezierCurve<glm::vec3>;
+template class BezierComposite<glm::vec3>;
+
+// Tracks are cheap to evaluate, so only large track counts are worth splitting over threads
+static constexpr size_t TRACKS_PER_JOB = 256UL;
+
+// Replace element idx by the last one, then drop the last one
+template<typename... Vectors>
+static void swapRemove(size_t idx, Vectors&... vectors) {
+    ((vectors[idx] = std::move(vectors.back()), vectors.pop_back()), ...);
 }
 
-void BezierCurveManager::timeStep(std::chrono::time_point<std::chrono::high_resolution_clock> curr_time) {
-    float delta = std::chrono::duration<float>(curr_time - startTime).count();
-    std::vector<size_t> deletionIndices;
-    
-    // 3D curves w/ deletion of curves having free'd meshes
-    deletionIndices.clear();
-    for (size_t curveIdx = 0UL; curveIdx < curves3d.size(); curveIdx++){
-        if (!curves3d.at(curveIdx).positionAtTime(delta)) { deletionIndices.push_back(curveIdx); }
+AnimationHandle BezierCurveManager::add3d(const BezierCurve<glm::vec3>& curve, MeshTree& node, uint32_t arcLengthSamples) {
+    return addTrack({ curve }, false, curve.totalTime, arcLengthSamples, node);
+}
+
+AnimationHandle BezierCurveManager::add3dComposite(const BezierComposite<glm::vec3>& composite, MeshTree& node, uint32_t arcLengthSamples) {
+    return addTrack(composite.m_curves, composite.loop, composite.total, arcLengthSamples, node);
+}
+
+AnimationHandle BezierCurveManager::addRotation(const RotationTrack& track, MeshTree& node) {
+    m_rotationFirstKeys.push_back(static_cast<uint32_t>(m_keyTimes.size()));
+    m_rotationNumKeys.push_back(static_cast<uint32_t>(track.keys.size()));
+    m_rotationLoops.push_back(track.loop);
+    m_rotationInterpolations.push_back(track.interpolation);
+    m_rotationTargets.push_back(&node.transform.selfOrientation);
+#ifndef NDEBUG
+    assert(!node.weak_from_this().expired() && "Animated nodes must be owned by a shared_ptr");
+    m_rotationNodes.push_back(node.weak_from_this());
+#endif
+    m_keyTimes.insert(m_keyTimes.end(), track.keyTimes.begin(), track.keyTimes.end());
+    m_keyRotations.insert(m_keyRotations.end(), track.keys.begin(), track.keys.end());
+    m_keyIntermediates.insert(m_keyIntermediates.end(), track.intermediates.begin(), track.intermediates.end());
+
+    const AnimationHandle handle = allocateSlot(TrackKind::Rotation, static_cast<uint32_t>(m_rotationTargets.size() - 1UL), node);
+    m_rotationSlots.push_back(handle.slot);
+    return handle;
+}
+
+AnimationHandle BezierCurveManager::addTrack(const std::vector<BezierCurve<glm::vec3>>& curves, bool loop, float total, uint32_t arcLengthSamples, MeshTree& node) {
+    if (curves.empty()) { throw std::invalid_argument("Bezier tracks need at least one curve"); }
+
+    m_trackFirstSegments.push_back(static_cast<uint32_t>(m_segmentStarts.size()));
+    m_trackNumSegments.push_back(static_cast<uint32_t>(curves.size()));
+    m_trackTotals.push_back(total);
+    m_trackLoops.push_back(loop);
+    m_trackTargets.push_back(&node.transform.translate);
+#ifndef NDEBUG
+    assert(!node.weak_from_this().expired() && "Animated nodes must be owned by a shared_ptr");
+    m_trackNodes.push_back(node.weak_from_this());
+#endif
+
+    // Coefficients are padded with w = 0 so every segment evaluates as a single vec4
+    float segmentStart = 0.0f;
+    for (const BezierCurve<glm::vec3>& curve : curves) {
+        std::array<glm::vec4, 4> coefficients;
+        for (size_t coefficientIdx = 0UL; coefficientIdx < coefficients.size(); coefficientIdx++) {
+            coefficients[coefficientIdx] = glm::vec4(curve.coefficients[coefficientIdx], 0.0f);
+        }
+        m_segmentCoefficients.push_back(coefficients);
+        m_segmentStarts.push_back(segmentStart);
+        m_segmentInvDurations.push_back(curve.totalTime > 0.0f ? 1.0f / curve.totalTime : 0.0f);
+        segmentStart += std::max(curve.totalTime, 0.0f);
+        m_segmentEnds.push_back(segmentStart);
+
+        m_segmentFirstArcLengths.push_back(static_cast<uint32_t>(m_arcLengths.size()));
+        if (arcLengthSamples > 0U) {
+            const std::vector<float> arcLengths = curve.arcLengthTable(arcLengthSamples);
+            m_arcLengths.insert(m_arcLengths.end(), arcLengths.begin(), arcLengths.end());
+            m_segmentNumArcLengths.push_back(static_cast<uint32_t>(arcLengths.size()));
+        } else {
+            m_segmentNumArcLengths.push_back(0U);
+        }
     }
-    for (size_t deletionIdx : std::views::reverse(deletionIndices)) { curves3d.erase(curves3d.begin() + deletionIdx); }
 
-    // 4D curves w/ deletion of curves having free'd meshes
-    deletionIndices.clear();
-    for (size_t curveIdx = 0UL; curveIdx < curves4d.size(); curveIdx++){
-        if (!curves4d.at(curveIdx).positionAtTime(delta)) { deletionIndices.push_back(curveIdx); }
+    const AnimationHandle handle = allocateSlot(TrackKind::Position, static_cast<uint32_t>(m_trackTargets.size() - 1UL), node);
+    m_trackSlots.push_back(handle.slot);
+    return handle;
+}
+
+AnimationHandle BezierCurveManager::allocateSlot(TrackKind kind, uint32_t denseIdx, MeshTree& node) {
+    uint32_t slotIdx;
+    if (m_freeSlots.empty()) {
+        slotIdx = static_cast<uint32_t>(m_slots.size());
+        m_slots.push_back({ denseIdx, 0U, kind });
+    } else {
+        slotIdx = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        m_slots[slotIdx].denseIdx   = denseIdx;
+        m_slots[slotIdx].kind       = kind;
     }
-    for (size_t deletionIdx : std::views::reverse(deletionIndices)) { curves4d.erase(curves4d.begin() + deletionIdx); }
 
-    // 3D composite curves w/ deletion of curves having free'd meshes
-    deletionIndices.clear();
-    for (size_t curveIdx = 0UL; curveIdx < compCurves3d.size(); curveIdx++){
-        if (!compCurves3d.at(curveIdx).positionAtTime(delta)) { deletionIndices.push_back(curveIdx); }
+    const AnimationHandle handle = { slotIdx, m_slots[slotIdx].generation };
+    node.animations.push_back(handle);
+    return handle;
+}
+
+bool BezierCurveManager::isValid(AnimationHandle handle) const {
+    return handle.slot < m_slots.size() && m_slots[handle.slot].generation == handle.generation;
+}
+
+void BezierCurveManager::remove(AnimationHandle handle) {
+    if (!isValid(handle)) { return; }
+
+    TrackSlot& slot = m_slots[handle.slot];
+    if (slot.kind == TrackKind::Position)   { removeTrack(slot.denseIdx); }
+    else                                    { removeRotationTrack(slot.denseIdx); }
+    slot.generation++;
+    m_freeSlots.push_back(handle.slot);
+}
+
+void BezierCurveManager::removeTrack(uint32_t trackIdx) {
+    m_deadSegments += m_trackNumSegments[trackIdx];
+    if (trackIdx + 1UL != m_trackSlots.size()) { m_slots[m_trackSlots.back()].denseIdx = trackIdx; }
+    swapRemove(trackIdx, m_trackFirstSegments, m_trackNumSegments, m_trackTotals, m_trackLoops, m_trackTargets, m_trackSlots);
+#ifndef NDEBUG
+    swapRemove(trackIdx, m_trackNodes);
+#endif
+    if (m_deadSegments * 2UL > m_segmentStarts.size()) { compactSegments(); }
+}
+
+void BezierCurveManager::removeRotationTrack(uint32_t trackIdx) {
+    m_deadKeys += m_rotationNumKeys[trackIdx];
+    if (trackIdx + 1UL != m_rotationSlots.size()) { m_slots[m_rotationSlots.back()].denseIdx = trackIdx; }
+    swapRemove(trackIdx, m_rotationFirstKeys, m_rotationNumKeys, m_rotationLoops, m_rotationInterpolations, m_rotationTargets, m_rotationSlots);
+#ifndef NDEBUG
+    swapRemove(trackIdx, m_rotationNodes);
+#endif
+    if (m_deadKeys * 2UL > m_keyTimes.size()) { compactKeys(); }
+}
+
+void BezierCurveManager::compactSegments() {
+    // Rebuilt in track order, which also restores sequential access during evaluation
+    std::vector<std::array<glm::vec4, 4>> coefficients;
+    std::vector<float> starts, ends, invDurations, arcLengths;
+    std::vector<uint32_t> firstArcLengths, numArcLengths;
+    const size_t liveSegments = m_segmentStarts.size() - m_deadSegments;
+    coefficients.reserve(liveSegments);
+    starts.reserve(liveSegments);
+    ends.reserve(liveSegments);
+    invDurations.reserve(liveSegments);
+    firstArcLengths.reserve(liveSegments);
+    numArcLengths.reserve(liveSegments);
+    for (size_t trackIdx = 0UL; trackIdx < m_trackFirstSegments.size(); trackIdx++) {
+        const size_t firstSegment           = m_trackFirstSegments[trackIdx];
+        const size_t lastSegment            = firstSegment + m_trackNumSegments[trackIdx];
+        m_trackFirstSegments[trackIdx]      = static_cast<uint32_t>(starts.size());
+        coefficients.insert(coefficients.end(), m_segmentCoefficients.begin() + firstSegment, m_segmentCoefficients.begin() + lastSegment);
+        starts.insert(starts.end(), m_segmentStarts.begin() + firstSegment, m_segmentStarts.begin() + lastSegment);
+        ends.insert(ends.end(), m_segmentEnds.begin() + firstSegment, m_segmentEnds.begin() + lastSegment);
+        invDurations.insert(invDurations.end(), m_segmentInvDurations.begin() + firstSegment, m_segmentInvDurations.begin() + lastSegment);
+        for (size_t segmentIdx = firstSegment; segmentIdx < lastSegment; segmentIdx++) {
+            const auto tableBegin = m_arcLengths.begin() + m_segmentFirstArcLengths[segmentIdx];
+            firstArcLengths.push_back(static_cast<uint32_t>(arcLengths.size()));
+            numArcLengths.push_back(m_segmentNumArcLengths[segmentIdx]);
+            arcLengths.insert(arcLengths.end(), tableBegin, tableBegin + m_segmentNumArcLengths[segmentIdx]);
+        }
     }
-    for (size_t deletionIdx : std::views::reverse(deletionIndices)) { compCurves3d.erase(compCurves3d.begin() + deletionIdx); }
+    m_segmentCoefficients       = std::move(coefficients);
+    m_segmentStarts             = std::move(starts);
+    m_segmentEnds               = std::move(ends);
+    m_segmentInvDurations       = std::move(invDurations);
+    m_segmentFirstArcLengths    = std::move(firstArcLengths);
+    m_segmentNumArcLengths      = std::move(numArcLengths);
+    m_arcLengths                = std::move(arcLengths);
+    m_deadSegments              = 0UL;
+}
 
-    // 4D composite curves w/ deletion of curves having free'd meshes
-    deletionIndices.clear();
-    for (size_t curveIdx = 0UL; curveIdx < compCurves4d.size(); curveIdx++){
-        if (!compCurves4d.at(curveIdx).positionAtTime(delta)) { deletionIndices.push_back(curveIdx); }
+void BezierCurveManager::compactKeys() {
+    std::vector<float> times;
+    std::vector<glm::quat> rotations, intermediates;
+    const size_t liveKeys = m_keyTimes.size() - m_deadKeys;
+    times.reserve(liveKeys);
+    rotations.reserve(liveKeys);
+    intermediates.reserve(liveKeys);
+    for (size_t trackIdx = 0UL; trackIdx < m_rotationFirstKeys.size(); trackIdx++) {
+        const size_t firstKey           = m_rotationFirstKeys[trackIdx];
+        const size_t lastKey            = firstKey + m_rotationNumKeys[trackIdx];
+        m_rotationFirstKeys[trackIdx]   = static_cast<uint32_t>(times.size());
+        times.insert(times.end(), m_keyTimes.begin() + firstKey, m_keyTimes.begin() + lastKey);
+        rotations.insert(rotations.end(), m_keyRotations.begin() + firstKey, m_keyRotations.begin() + lastKey);
+        intermediates.insert(intermediates.end(), m_keyIntermediates.begin() + firstKey, m_keyIntermediates.begin() + lastKey);
     }
-    for (size_t deletionIdx : std::views::reverse(deletionIndices)) { compCurves4d.erase(compCurves4d.begin() + deletionIdx); }
+    m_keyTimes          = std::move(times);
+    m_keyRotations      = std::move(rotations);
+    m_keyIntermediates  = std::move(intermediates);
+    m_deadKeys          = 0UL;
+}
+
+void BezierCurveManager::evaluateAll(float t, utils::JobSystem& jobSystem) {
+    const size_t numTracks = m_trackTargets.size();
+    m_activeSegments.resize(numTracks);
+    m_localTimes.resize(numTracks);
+    m_values.resize(numTracks);
+
+    const utils::JobHandle positionsDone = jobSystem.parallelFor(numTracks, TRACKS_PER_JOB, [this, t](size_t begin, size_t end) {
+        // Find each track's active segment. Clamping u to [0, 1] pins times before the first or past the last segment to the end points
+        for (size_t trackIdx = begin; trackIdx < end; trackIdx++) {
+            float trackTime         = t;
+            const float trackTotal  = m_trackTotals[trackIdx];
+            if (m_trackLoops[trackIdx] && trackTotal > 0.0f) { trackTime -= trackTotal * std::floor(trackTime / trackTotal); }
+
+            const auto segmentsBegin        = m_segmentEnds.begin() + m_trackFirstSegments[trackIdx];
+            const auto segmentsEnd          = segmentsBegin + m_trackNumSegments[trackIdx];
+            const auto activeIter           = std::min(std::upper_bound(segmentsBegin, segmentsEnd, trackTime), segmentsEnd - 1);
+            const size_t segmentIdx         = static_cast<size_t>(std::distance(m_segmentEnds.begin(), activeIter));
+            const float timeFraction        = std::clamp((trackTime - m_segmentStarts[segmentIdx]) * m_segmentInvDurations[segmentIdx], 0.0f, 1.0f);
+            m_activeSegments[trackIdx]      = static_cast<uint32_t>(segmentIdx);
+
+            // Constant-speed segments cover the same fraction of their length as of their duration
+            const uint32_t numArcLengths    = m_segmentNumArcLengths[segmentIdx];
+            m_localTimes[trackIdx]          = numArcLengths == 0U ? timeFraction : BezierCurve<glm::vec3>::parameterAtArcLength(
+                                                std::span(m_arcLengths).subspan(m_segmentFirstArcLengths[segmentIdx], numArcLengths), timeFraction);
+        }
+
+        // Horner's rule on all four components at once
+        for (size_t trackIdx = begin; trackIdx < end; trackIdx++) {
+            const std::array<glm::vec4, 4>& coefficients    = m_segmentCoefficients[m_activeSegments[trackIdx]];
+            const utils::Float4 u                           = utils::Float4::broadcast(m_localTimes[trackIdx]);
+            utils::Float4 value                             = utils::Float4::load(&coefficients[3].x);
+            value                                           = utils::Float4::multiplyAdd(value, u, utils::Float4::load(&coefficients[2].x));
+            value                                           = utils::Float4::multiplyAdd(value, u, utils::Float4::load(&coefficients[1].x));
+            value                                           = utils::Float4::multiplyAdd(value, u, utils::Float4::load(&coefficients[0].x));
+            value.store(&m_values[trackIdx].x);
+        }
+    });
+
+    // Rotation tracks interpolate quaternion keys, so no axis-angle conversion is needed on the way to the transform
+    m_rotationValues.resize(m_rotationTargets.size());
+    const utils::JobHandle rotationsDone = jobSystem.parallelFor(m_rotationTargets.size(), TRACKS_PER_JOB, [this, t](size_t begin, size_t end) {
+        for (size_t trackIdx = begin; trackIdx < end; trackIdx++) {
+            const size_t firstKey   = m_rotationFirstKeys[trackIdx];
+            const size_t numKeys    = m_rotationNumKeys[trackIdx];
+            if (numKeys == 1UL) {
+                m_rotationValues[trackIdx] = m_keyRotations[firstKey];
+                continue;
+            }
+            const auto [keyOffset, h]   = RotationTrack::locateKey(std::span(m_keyTimes).subspan(firstKey, numKeys), m_rotationLoops[trackIdx], t);
+            const size_t keyIdx         = firstKey + keyOffset;
+            m_rotationValues[trackIdx]  = RotationTrack::interpolate(m_rotationInterpolations[trackIdx], m_keyRotations[keyIdx], m_keyRotations[keyIdx + 1UL],
+                                                                     m_keyIntermediates[keyIdx], m_keyIntermediates[keyIdx + 1UL], h);
+        }
+    });
+    jobSystem.wait(positionsDone);
+    jobSystem.wait(rotationsDone);
+}
+
+void BezierCurveManager::timeStep(std::chrono::time_point<std::chrono::high_resolution_clock> curr_time, utils::JobSystem& jobSystem) {
+    float delta = std::chrono::duration<float>(curr_time - startTime).count();
+
+    evaluateAll(delta, jobSystem);
+#ifndef NDEBUG
+    for (const std::weak_ptr<MeshTree>& node : m_trackNodes)    { assert(!node.expired() && "Animated node freed without removing its tracks"); }
+    for (const std::weak_ptr<MeshTree>& node : m_rotationNodes) { assert(!node.expired() && "Animated node freed without removing its tracks"); }
+#endif
+    for (size_t trackIdx = 0UL; trackIdx < m_trackTargets.size(); trackIdx++)       { *m_trackTargets[trackIdx]     = glm::vec3(m_values[trackIdx]); }
+    for (size_t trackIdx = 0UL; trackIdx < m_rotationTargets.size(); trackIdx++)    { *m_rotationTargets[trackIdx]  = m_rotationValues[trackIdx]; }
 }
@@ -7,108 +7,148 @@ DISABLE_WARNINGS_PUSH()
 #include <glm/vec4.hpp>
 DISABLE_WARNINGS_POP()
 
+#include <render/animation_handle.h>
 #include <render/mesh_tree.h>
+#include <render/rotation_track.h>
+#include <utils/job_system.hpp>
 #include <array>
-#include <cmath>
-#include <ctime>
-#include <vector>
 #include <chrono>
-#include <ranges>
-#include <time.h>
+#include <memory>
+#include <span>
+#include <stdint.h>
+#include <vector>
 
 template<typename Type>
-class BezierCurveBase {
+class BezierCurve {
 public:
-    // template<typename Type>
-    Type positionAtTime(float t) const { return Type { 0.0f }; }
-};
+    BezierCurve(Type p1t, Type p2t, Type p3t, Type p4t, float total_timet);
 
-template<typename Type>
-class BezierCurve : public BezierCurveBase<Type> {
-public:
-    BezierCurve(Type p1t, Type p2t, Type p3t, Type p4t, float total_timet)
-    : controlP0(p1t), controlP1(p2t), controlP2(p3t), controlP3(p4t)
-    , totalTime(total_timet) {};
-    
-    Type positionAtTime(float t);
+    // Clamped to the end points outside of [0, totalTime]
+    Type positionAtTime(float t) const;
+
+    // Arc length covered at numSamples (at least 2) evenly spaced parameters, normalised to [0, 1] and measured along the chords
+    std::vector<float> arcLengthTable(uint32_t numSamples) const;
+
+    // Parameter u in [0, 1] at which the given fraction of the curve's length is covered, interpolated from an arc length table
+    static float parameterAtArcLength(std::span<const float> arcLengths, float lengthFraction);
 
     float totalTime = -1;
     Type controlP0, controlP1, controlP2, controlP3;
+
+    // Power basis form c0 + c1 * u + c2 * u^2 + c3 * u^3 of the curve (u = t / totalTime), evaluated with Horner's rule
+    std::array<Type, 4> coefficients;
 };
 
 template<typename Type>
-class BezierComposite : public BezierCurveBase<Type> {
+class BezierComposite {
 public:
-    BezierComposite(const std::vector<BezierCurve<Type>>& curves, bool toLoop, float completeTime)
-    : loop(toLoop)
-    , m_curves(curves)
-    , total(completeTime) {};
+    BezierComposite(const std::vector<BezierCurve<Type>>& curves, bool toLoop, float completeTime);
 
-    Type positionAtTime(float t);
+    // Looping composites wrap t into [0, total), others are clamped to the first and last control points
+    Type positionAtTime(float t) const;
 
     float total = 0;
     bool loop   = false;
     std::vector<BezierCurve<Type>> m_curves;
+    std::vector<float> m_segmentEnds; // Prefix sums of the curves' durations, binary searched to find the active curve
 };
 
-template<typename Type>
-class BezierCombo {
-public:
-    BezierCombo(const BezierCurve<Type>& curve, Type* toMove, std::weak_ptr<MeshTree> obj)
-    : curve(curve)
-    , toMove(toMove)
-    , obj(obj) {};
-    
-    bool positionAtTime(float t);
-
-    BezierCurve<Type> curve;
-    Type* toMove;
-    std::weak_ptr<MeshTree> obj;
-};
-
-template<typename Type>
-class BezierComboComposite {
-public:
-    BezierComboComposite(const BezierComposite<Type>& curve, Type* toMove, std::weak_ptr<MeshTree> obj)
-    : curve(curve)
-    , toMove(toMove)
-    , obj(obj) {};
-
-    bool positionAtTime(float t);
-
-    BezierComposite<Type> curve;
-    Type* toMove;
-    std::weak_ptr<MeshTree> obj;
-};
-
+// Position tracks animate MeshTransform::translate, rotation tracks (see RotationTrack) MeshTransform::selfOrientation. Every
+// position curve is flattened into a track of one or more segments stored structure-of-arrays with precomputed coefficients, so a
+// frame is a binary search per track followed by a SIMD Horner evaluation over all of them. Tracks live in dense arrays behind
+// generational handles: removal is a swap with the last track, and the variable-length segment and key pools are compacted once
+// more than half of them belong to removed tracks
 class BezierCurveManager {
 public:
     BezierCurveManager(std::chrono::time_point<std::chrono::high_resolution_clock> startTime) : startTime(startTime) {};
-    
-    void timeStep(std::chrono::time_point<std::chrono::high_resolution_clock> curr_time);
-    
-    size_t add3d(const BezierCombo<glm::vec3>& curve3d){
-        curves3d.push_back(curve3d);
-        return curves3d.size() - 1UL;
-    }
-    size_t add3dComposite(const BezierComboComposite<glm::vec3>& curve3d){
-        compCurves3d.push_back(curve3d);
-        return compCurves3d.size() - 1UL;
-    }
-    size_t add4d(const BezierCombo<glm::vec4>& curve4d){
-        curves4d.push_back(curve4d);
-        return curves4d.size() - 1UL;
-    }
-    size_t add4dComposite(const BezierComboComposite<glm::vec4>& curve4d){
-        compCurves4d.push_back(curve4d);
-        return compCurves4d.size() - 1UL;
-    }
-
-    std::vector<BezierCombo<glm::vec3>> curves3d;
-    std::vector<BezierCombo<glm::vec4>> curves4d;
-    std::vector<BezierComboComposite<glm::vec3>> compCurves3d;
-    std::vector<BezierComboComposite<glm::vec4>> compCurves4d;
+
+    // Evaluate all tracks and write them to their nodes' transforms
+    void timeStep(std::chrono::time_point<std::chrono::high_resolution_clock> curr_time, utils::JobSystem& jobSystem);
+
+    // Evaluate every track at t seconds (positions are padded with w = 0), in dense track order. Tracks are independent, so
+    // batches of them are evaluated in parallel
+    void evaluateAll(float t, utils::JobSystem& jobSystem);
+    const std::vector<glm::vec4>& getValues() const     { return m_values; }
+    const std::vector<glm::quat>& getRotations() const  { return m_rotationValues; }
+
+    // Tracks write through pointers into the node, so the node must release them before being freed (see MeshTree::clean);
+    // debug builds check this every time step, using the shared_ptr owning the node. Position tracks with arcLengthSamples > 0
+    // move at constant speed along each curve (as opposed to uniformly in the curve parameter), using an arc length table with
+    // that many entries per curve
+    AnimationHandle add3d(const BezierCurve<glm::vec3>& curve, MeshTree& node, uint32_t arcLengthSamples = 0U);
+    AnimationHandle add3dComposite(const BezierComposite<glm::vec3>& composite, MeshTree& node, uint32_t arcLengthSamples = 0U);
+    AnimationHandle addRotation(const RotationTrack& track, MeshTree& node);
+    bool isValid(AnimationHandle handle) const;
+    void remove(AnimationHandle handle); // No-op for stale handles
+    size_t numTracks() const            { return m_trackTargets.size(); }
+    size_t numRotationTracks() const    { return m_rotationTargets.size(); }
+
     std::chrono::time_point<std::chrono::high_resolution_clock> startTime;
+
+private:
+    enum class TrackKind : uint32_t { Position, Rotation };
+    struct TrackSlot {
+        uint32_t denseIdx;
+        uint32_t generation;
+        TrackKind kind;
+    };
+
+    AnimationHandle allocateSlot(TrackKind kind, uint32_t denseIdx, MeshTree& node);
+    AnimationHandle addTrack(const std::vector<BezierCurve<glm::vec3>>& curves, bool loop, float total, uint32_t arcLengthSamples, MeshTree& node);
+    void removeTrack(uint32_t trackIdx);
+    void removeRotationTrack(uint32_t trackIdx);
+    void compactSegments();
+    void compactKeys();
+
+    // Handle slots
+    std::vector<TrackSlot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+
+    // Segments of all position tracks, in blocks of consecutive segments
+    std::vector<std::array<glm::vec4, 4>> m_segmentCoefficients;
+    std::vector<float> m_segmentStarts;             // Relative to the track's start
+    std::vector<float> m_segmentEnds;               // Relative to the track's start, ascending within a track
+    std::vector<float> m_segmentInvDurations;
+    std::vector<uint32_t> m_segmentFirstArcLengths;
+    std::vector<uint32_t> m_segmentNumArcLengths;   // Zero for segments evaluated uniformly in the curve parameter
+    size_t m_deadSegments { 0UL };                  // Belonging to removed tracks
+
+    // Arc length tables of the segments, back to back
+    std::vector<float> m_arcLengths;
+
+    // Position tracks
+    std::vector<uint32_t> m_trackFirstSegments;
+    std::vector<uint32_t> m_trackNumSegments;
+    std::vector<float> m_trackTotals;           // Loop period
+    std::vector<uint8_t> m_trackLoops;
+    std::vector<glm::vec3*> m_trackTargets;
+    std::vector<uint32_t> m_trackSlots;
+
+    // Per-evaluation scratch, one entry per position track
+    std::vector<uint32_t> m_activeSegments;
+    std::vector<float> m_localTimes;            // Curve parameter in [0, 1] within the active segment
+    std::vector<glm::vec4> m_values;
+
+    // Keys of all rotation tracks, in blocks of consecutive keys
+    std::vector<float> m_keyTimes;
+    std::vector<glm::quat> m_keyRotations;
+    std::vector<glm::quat> m_keyIntermediates;
+    size_t m_deadKeys { 0UL };
+
+    // Rotation tracks
+    std::vector<uint32_t> m_rotationFirstKeys;
+    std::vector<uint32_t> m_rotationNumKeys;
+    std::vector<uint8_t> m_rotationLoops;
+    std::vector<RotationInterpolation> m_rotationInterpolations;
+    std::vector<glm::quat*> m_rotationTargets;
+    std::vector<uint32_t> m_rotationSlots;
+    std::vector<glm::quat> m_rotationValues;
+
+#ifndef NDEBUG
+    // Nodes owning the targets, only used to catch tracks outliving their node
+    std::vector<std::weak_ptr<MeshTree>> m_trackNodes;
+    std::vector<std::weak_ptr<MeshTree>> m_rotationNodes;
+#endif
 };
 
 #endif
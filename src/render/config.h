@@ -40,6 +40,13 @@ struct RenderConfig {
     float defaultRoughness  { 0.0f };
     float defaultAO         { 0.0f };
 
+    // Geometry submission
+    bool enableGpuCulling { true }; // Frustum cull static geometry in a compute shader and render it with indirect draws
+
+    // Material texture residency
+    int32_t materialTextureBudgetMB     { 128 };    // VRAM for the material texture arrays; least recently drawn textures are evicted past this
+    int32_t textureStreamingKBPerFrame  { 2048 };   // Upload budget for streaming in finer mips
+
     // HDR tonemapping and gamma correction
     bool enableHdr  { true };
     float exposure  { 1.0f };
@@ -64,6 +71,12 @@ struct RenderConfig {
     float colorDeviation    { 0.1f };
     float lifeDeviation     { 25.0f };
     float sizeDeviation     { 0.005f };
+    bool gpuParticles       { false };  // Simulate and depth sort particles in compute shaders
+    bool particleOIT        { false };  // Weighted blended order-independent transparency; no depth sorting needed
+    bool particleCulling    { true };   // Freeze emitters outside of the view frustum
+    float particleLodNear   { 4.0f };   // Distance up to which emitters simulate and draw all of their particles
+    float particleLodFar    { 16.0f };  // Distance from which emitters only use the minimum fraction of their particles
+    float particleLodMinFraction { 0.25f };
 
     // Parallax mapping
     float heightScale       { 0.025f };
@@ -19,7 +19,8 @@ DeferredRenderer::DeferredRenderer(RenderConfig& renderConfig, Scene& scene, Lig
     , m_particleEmitterManager(particleEmitterManager)
     , m_xToonTex(xToonTex)
     , bloomFilter(renderConfig)
-    , ssaoFilter(utils::WIDTH, utils::HEIGHT, renderConfig) {
+    , ssaoFilter(utils::WIDTH, utils::HEIGHT, renderConfig)
+    , materialManager(renderConfig) {
     initBuffers();
     initShaders();
 }
@@ -36,6 +37,11 @@ DeferredRenderer::~DeferredRenderer() {
     // HDR buffer
     glDeleteBuffers(1, &hdrBuffer);
     glDeleteTextures(1, &hdrTex);
+
+    // OIT buffer
+    glDeleteFramebuffers(1, &oitBuffer);
+    glDeleteTextures(1, &accumulationTex);
+    glDeleteTextures(1, &revealageTex);
 }
 
 void DeferredRenderer::render(const glm::mat4& viewProjection, const glm::vec3& cameraPos) {
@@ -106,9 +112,35 @@ void DeferredRenderer::initHdrBuffer() {
     if (glCheckNamedFramebufferStatus(hdrBuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) { std::cerr << "Failed to initialise HDR intermediate framebuffer" << std::endl; }
 }
 
+void DeferredRenderer::initOitBuffer() {
+    // Create OIT buffer
+    glCreateFramebuffers(1, &oitBuffer);
+
+    // Create and attach accumulation (weighted premultiplied colour and alpha) and revealage textures
+    glCreateTextures(GL_TEXTURE_2D, 1, &accumulationTex);
+    glTextureStorage2D(accumulationTex, 1, GL_RGBA16F, utils::WIDTH, utils::HEIGHT);
+    glTextureParameteri(accumulationTex, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(accumulationTex, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glNamedFramebufferTexture(oitBuffer, GL_COLOR_ATTACHMENT0, accumulationTex, 0);
+    glCreateTextures(GL_TEXTURE_2D, 1, &revealageTex);
+    glTextureStorage2D(revealageTex, 1, GL_R16F, utils::WIDTH, utils::HEIGHT);
+    glTextureParameteri(revealageTex, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(revealageTex, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glNamedFramebufferTexture(oitBuffer, GL_COLOR_ATTACHMENT1, revealageTex, 0);
+    constexpr std::array<GLenum, 2UL> attachments = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glNamedFramebufferDrawBuffers(oitBuffer, static_cast<GLsizei>(attachments.size()), attachments.data());
+
+    // Transparent fragments are depth tested against the opaque geometry in the HDR buffer
+    glNamedFramebufferRenderbuffer(oitBuffer, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepthHDR);
+
+    // Check if framebuffer is complete
+    if (glCheckNamedFramebufferStatus(oitBuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) { std::cerr << "Failed to initialise OIT framebuffer" << std::endl; }
+}
+
 void DeferredRenderer::initBuffers() {
     initGBuffer();
     initHdrBuffer();
+    initOitBuffer();
 }
 
 void DeferredRenderer::initLightingShader() {
@@ -146,76 +178,50 @@ void DeferredRenderer::initShaders() {
         geometryPassBuilder.addStage(GL_FRAGMENT_SHADER, utils::SHADERS_DIR_PATH / "deferred" / "deferred.frag");
         geometryPass = geometryPassBuilder.build();
 
+        ShaderBuilder geometryPassIndirectBuilder;
+        geometryPassIndirectBuilder.addStage(GL_VERTEX_SHADER, utils::SHADERS_DIR_PATH / "deferred" / "deferred_indirect.vert");
+        geometryPassIndirectBuilder.addStage(GL_FRAGMENT_SHADER, utils::SHADERS_DIR_PATH / "deferred" / "deferred.frag");
+        geometryPassIndirect = geometryPassIndirectBuilder.build();
+
         ShaderBuilder hdrBuilder;
         hdrBuilder.addStage(GL_VERTEX_SHADER, utils::SHADERS_DIR_PATH / "screen-quad.vert");
         hdrBuilder.addStage(GL_FRAGMENT_SHADER, utils::SHADERS_DIR_PATH / "hdr.frag");
         hdrRender = hdrBuilder.build();
+
+        ShaderBuilder oitResolveBuilder;
+        oitResolveBuilder.addStage(GL_VERTEX_SHADER, utils::SHADERS_DIR_PATH / "screen-quad.vert");
+        oitResolveBuilder.addStage(GL_FRAGMENT_SHADER, utils::SHADERS_DIR_PATH / "oit_resolve.frag");
+        oitResolve = oitResolveBuilder.build();
     } catch (ShaderLoadingException e) { std::cerr << e.what() << std::endl; }
 
     // Lighting pass
     initLightingShader();
 }
 
-void DeferredRenderer::bindMaterialTextures(const GPUMesh& mesh, const glm::vec3& cameraPos) const {
-    // Albedo
-    if (!mesh.getAlbedo().expired()) {
-        mesh.getAlbedo().lock()->bind(GL_TEXTURE0);
-        glUniform1i(3, 0);
-    }
-    glUniform1i(4, !mesh.getNormal().expired());
-    glUniform4fv(5, 1, glm::value_ptr(m_renderConfig.defaultAlbedo));
-
-    // Normal
-    if (!mesh.getNormal().expired()) {
-        mesh.getNormal().lock()->bind(GL_TEXTURE0 + 1);
-        glUniform1i(6, 1);
-    }
-    glUniform1i(7, !mesh.getNormal().expired());
-
-    // Metallic
-    if (!mesh.getMetallic().expired()) {
-        mesh.getMetallic().lock()->bind(GL_TEXTURE0 + 2);
-        glUniform1i(8, 2);
-    }
-    glUniform1i(9, !mesh.getMetallic().expired());
-    glUniform1f(10, m_renderConfig.defaultMetallic);
-
-    // Roughness
-    if (!mesh.getRoughness().expired()) {
-        mesh.getRoughness().lock()->bind(GL_TEXTURE0 + 3);
-        glUniform1i(11, 3);
-    }
-    glUniform1i(12, !mesh.getRoughness().expired());
-    glUniform1f(13, m_renderConfig.defaultRoughness);
-
-    // AO
-    if (!mesh.getAO().expired()) {
-        mesh.getAO().lock()->bind(GL_TEXTURE0 + 4);
-        glUniform1i(14, 4);
-    }
-    glUniform1i(15, !mesh.getAO().expired());
-    glUniform1f(16, m_renderConfig.defaultAO);
-
-    // Displacement
-    if (!mesh.getDisplacement().expired()) {
-        mesh.getDisplacement().lock()->bind(GL_TEXTURE0 + 5);
-        glUniform1i(17, 5);
-    }
-    glUniform1i(18, !mesh.getDisplacement().expired());
-    glUniform1i(19, mesh.getIsHeight());
-    glUniform1f(20, m_renderConfig.heightScale);
-    glUniform1f(21, m_renderConfig.minDepthLayers);
-    glUniform1f(22, m_renderConfig.maxDepthLayers);
+void DeferredRenderer::bindMaterials(const glm::vec3& cameraPos) {
+    // Material table and texture arrays (units 0-2)
+    materialManager.bind();
+    glUniform1i(4, 0);
+    glUniform1i(5, 1);
+    glUniform1i(6, 2);
+
+    // Parallax mapping
+    glUniform1f(7, m_renderConfig.heightScale);
+    glUniform1f(8, m_renderConfig.minDepthLayers);
+    glUniform1f(9, m_renderConfig.maxDepthLayers);
     
     // Camera position
-    glUniform3fv(23, 1, glm::value_ptr(cameraPos));
+    glUniform3fv(10, 1, glm::value_ptr(cameraPos));
 }
 
-void DeferredRenderer::recursiveGeometryRender(MeshTree* mt, const glm::mat4& viewProjection, const glm::vec3& cameraPos) const {
+void DeferredRenderer::recursiveGeometryRender(MeshTree* mt, const glm::mat4& viewProjection, const glm::vec3& cameraPos) {
     if (mt == nullptr) { return; }
    
     const glm::mat4& modelMatrix = mt->modelMatrix();
-    if (mt->mesh != nullptr) {
+    if (mt->mesh != nullptr && mt->isStatic && m_renderConfig.enableGpuCulling) {
+        // Deferred to a single culled batch after the traversal
+        staticBatch.addInstance(*(mt->mesh), materialManager.materialIndex(*(mt->mesh)), modelMatrix, glm::inverseTranspose(glm::mat3(modelMatrix)));
+    } else if (mt->mesh != nullptr) {
         const GPUMesh& mesh = *(mt->mesh);
         
         // Normals should be transformed differently than positions (ignoring translations + dealing with scaling)
@@ -223,12 +229,14 @@ void DeferredRenderer::recursiveGeometryRender(MeshTree* mt, const glm::mat4& vi
         const glm::mat4 mvpMatrix           = viewProjection * modelMatrix;
         const glm::mat3 normalModelMatrix   = glm::inverseTranspose(glm::mat3(modelMatrix));
 
-        // Bind shader program, transformation matrices, and material property textures
-        geometryPass.bind();
+        // Bind transformation matrices and material index (shader and materials are bound once for the whole pass)
         glUniformMatrix4fv(0, 1, GL_FALSE, glm::value_ptr(mvpMatrix));
         glUniformMatrix4fv(1, 1, GL_FALSE, glm::value_ptr(modelMatrix));
         glUniformMatrix3fv(2, 1, GL_FALSE, glm::value_ptr(normalModelMatrix));
-        bindMaterialTextures(mesh, cameraPos);
+        glUniform1ui(3, materialManager.materialIndex(mesh));
+        glUniform3fv(11, 1, glm::value_ptr(mesh.getBoundsMin()));
+        glUniform3fv(12, 1, glm::value_ptr(utils::positionScale(mesh.getBoundsMin(), mesh.getBoundsMax())));
+        mesh.bindMorphTargets();
 
         mesh.draw();   
     }
@@ -245,7 +253,16 @@ void DeferredRenderer::recursiveGeometryRender(MeshTree* mt, const glm::mat4& vi
     }
 }
 
-void DeferredRenderer::renderGeometry(const glm::mat4& viewProjection, const glm::vec3& cameraPos) const {
+void DeferredRenderer::renderStaticGeometry(const glm::mat4& viewProjection, const glm::vec3& cameraPos) {
+    // Cull static instances gathered during traversal, then draw the survivors
+    staticBatch.cull(viewProjection);
+    geometryPassIndirect.bind();
+    glUniformMatrix4fv(0, 1, GL_FALSE, glm::value_ptr(viewProjection));
+    bindMaterials(cameraPos);
+    staticBatch.draw();
+}
+
+void DeferredRenderer::renderGeometry(const glm::mat4& viewProjection, const glm::vec3& cameraPos) {
     // Clear color and depth values then render each model
     glClearTexImage(positionTex,    0, GL_RGBA, GL_HALF_FLOAT, 0);
     glClearTexImage(normalTex,      0, GL_RGBA, GL_HALF_FLOAT, 0);
@@ -255,7 +272,12 @@ void DeferredRenderer::renderGeometry(const glm::mat4& viewProjection, const glm
 
     // Bind G-Buffer and render each model
     glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+    materialManager.beginFrame();
+    staticBatch.clear();
+    geometryPass.bind();
+    bindMaterials(cameraPos);
     recursiveGeometryRender(m_scene.root, viewProjection, cameraPos);
+    if (m_renderConfig.enableGpuCulling) { renderStaticGeometry(viewProjection, cameraPos); }
 }
 
 void DeferredRenderer::bindGBufferTextures() const {
@@ -306,7 +328,34 @@ void DeferredRenderer::renderLighting(const glm::vec3& cameraPos) {
 }
 
 void DeferredRenderer::renderForward(const glm::mat4& viewProjection) {
-    m_particleEmitterManager.render(hdrBuffer, viewProjection); // Only particles need forward shading for now
+    // Only particles need forward shading for now
+    if (!m_renderConfig.particleOIT) {
+        m_particleEmitterManager.render(hdrBuffer, viewProjection);
+        return;
+    }
+
+    // Weighted blended OIT: accumulate transparent fragments in any order...
+    constexpr std::array<GLfloat, 4UL> clearAccumulation    = { 0.0f, 0.0f, 0.0f, 0.0f };
+    constexpr GLfloat clearRevealage                        = 1.0f;
+    glClearNamedFramebufferfv(oitBuffer, GL_COLOR, 0, clearAccumulation.data());
+    glClearNamedFramebufferfv(oitBuffer, GL_COLOR, 1, &clearRevealage);
+    m_particleEmitterManager.render(oitBuffer, viewProjection);
+
+    // ...then composite their weighted average over the opaque HDR colour
+    glBindFramebuffer(GL_FRAMEBUFFER, hdrBuffer);
+    oitResolve.bind();
+    glActiveTexture(GL_TEXTURE0 + utils::HDR_BUFFER_TEX_START_IDX);
+    glBindTexture(GL_TEXTURE_2D, accumulationTex);
+    glUniform1i(0, utils::HDR_BUFFER_TEX_START_IDX);
+    glActiveTexture(GL_TEXTURE0 + utils::HDR_BUFFER_TEX_START_IDX + 1);
+    glBindTexture(GL_TEXTURE_2D, revealageTex);
+    glUniform1i(1, utils::HDR_BUFFER_TEX_START_IDX + 1);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    utils::renderQuad();
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
 }
 
 void DeferredRenderer::renderPostProcessing(const glm::mat4& viewProjection) {
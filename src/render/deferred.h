@@ -10,7 +10,9 @@ DISABLE_WARNINGS_POP()
 
 #include <render/bloom.h>
 #include <render/config.h>
+#include <render/indirect.h>
 #include <render/lighting.h>
+#include <render/material.h>
 #include <render/particle.h>
 #include <render/scene.h>
 #include <render/ssao.h>
@@ -33,12 +35,14 @@ public:
 private:
     void initGBuffer();
     void initHdrBuffer();
+    void initOitBuffer();
     void initBuffers();
     void initShaders();
 
-    void bindMaterialTextures(const GPUMesh& mesh, const glm::vec3& cameraPos) const;
-    void recursiveGeometryRender(MeshTree* mt, const glm::mat4& viewProjection, const glm::vec3& cameraPos) const;
-    void renderGeometry(const glm::mat4& viewProjection, const glm::vec3& cameraPos) const;
+    void bindMaterials(const glm::vec3& cameraPos);
+    void recursiveGeometryRender(MeshTree* mt, const glm::mat4& viewProjection, const glm::vec3& cameraPos);
+    void renderStaticGeometry(const glm::mat4& viewProjection, const glm::vec3& cameraPos);
+    void renderGeometry(const glm::mat4& viewProjection, const glm::vec3& cameraPos);
     
     void bindGBufferTextures() const;
     void renderLighting(const glm::vec3& cameraPos);
@@ -65,10 +69,17 @@ private:
     GLuint hdrTex;
     GLuint rboDepthHDR;
 
+    // Weighted blended order-independent transparency targets, sharing the HDR depth buffer
+    GLuint oitBuffer;
+    GLuint accumulationTex;
+    GLuint revealageTex;
+
     // Shaders and shader-specific info
     Shader geometryPass;
+    Shader geometryPassIndirect;
     Shader lightingPass;
     Shader hdrRender;
+    Shader oitResolve;
     std::weak_ptr<const Texture> m_xToonTex;
 
     RenderConfig& m_renderConfig;
@@ -79,6 +90,8 @@ private:
     // Objects managing other rendering bits
     BloomFilter bloomFilter;
     SSAOFilter ssaoFilter;
+    MaterialManager materialManager;
+    IndirectGeometryBatch staticBatch;
 };
 
 #endif
@@ -0,0 +1,144 @@
+#include "geometry_arena.h"
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <fmt/format.h>
+DISABLE_WARNINGS_POP()
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+GeometryArena* GeometryArena::s_active = nullptr;
+
+GeometryArena::GeometryArena(size_t initialVertexCapacity, size_t initialIndexBytes)
+    : m_vertexAllocator(initialVertexCapacity)
+    , m_indexAllocator(initialIndexBytes) {
+    // Mutable storage is required so that meshes can be uploaded after creation
+    glCreateBuffers(1, &m_vbo);
+    glNamedBufferStorage(m_vbo, static_cast<GLsizeiptr>(initialVertexCapacity * sizeof(CompactVertex)), nullptr, GL_DYNAMIC_STORAGE_BIT);
+    glCreateBuffers(1, &m_ibo);
+    glNamedBufferStorage(m_ibo, static_cast<GLsizeiptr>(initialIndexBytes), nullptr, GL_DYNAMIC_STORAGE_BIT);
+    initVertexArray();
+
+    s_active = this;
+}
+
+GeometryArena::~GeometryArena() {
+    glDeleteVertexArrays(1, &m_vao);
+    glDeleteBuffers(1, &m_vbo);
+    glDeleteBuffers(1, &m_ibo);
+    if (s_active == this) { s_active = nullptr; }
+}
+
+GeometryArena& GeometryArena::active() {
+    if (s_active == nullptr) { throw GeometryArenaException("No geometry arena exists to allocate meshes from"); }
+    return *s_active;
+}
+
+void GeometryArena::initVertexArray() {
+    // Bind vertex data to shader inputs using their index (location).
+    // These bindings are stored in the Vertex Array Object.
+    glCreateVertexArrays(1, &m_vao);
+
+    // The indices (pointing to vertices) should be read from the index buffer.
+    glVertexArrayElementBuffer(m_vao, m_ibo);
+
+    // We bind the vertex buffer to slot 0 of the VAO and tell the VBO how large each vertex is (stride).
+    glVertexArrayVertexBuffer(m_vao, 0, m_vbo, 0, sizeof(CompactVertex));
+
+    // Tell OpenGL that we will be using vertex attributes [0:3] (the bitangent is reconstructed in the shader)
+    glEnableVertexArrayAttrib(m_vao, 0);
+    glEnableVertexArrayAttrib(m_vao, 1);
+    glEnableVertexArrayAttrib(m_vao, 2);
+    glEnableVertexArrayAttrib(m_vao, 3);
+
+    // We tell OpenGL what each vertex looks like and how they are mapped to the shader (location = ...).
+    // Normalized integer attributes are converted to floats by the vertex fetch, so the shaders only decode the octahedral vectors
+    glVertexArrayAttribFormat(m_vao, 0, 4, GL_UNSIGNED_SHORT, true, offsetof(CompactVertex, position));
+    glVertexArrayAttribFormat(m_vao, 1, 2, GL_SHORT, true, offsetof(CompactVertex, normal));
+    glVertexArrayAttribFormat(m_vao, 2, 2, GL_HALF_FLOAT, false, offsetof(CompactVertex, texCoord));
+    glVertexArrayAttribFormat(m_vao, 3, 2, GL_SHORT, true, offsetof(CompactVertex, tangent));
+
+    // For each of the vertex attributes we tell OpenGL to get them from VBO at slot 0.
+    glVertexArrayAttribBinding(m_vao, 0, 0);
+    glVertexArrayAttribBinding(m_vao, 1, 0);
+    glVertexArrayAttribBinding(m_vao, 2, 0);
+    glVertexArrayAttribBinding(m_vao, 3, 0);
+}
+
+GeometryAllocation GeometryArena::allocate(std::span<const CompactVertex> vertices, std::span<const glm::uvec3> triangles) {
+    // Halve index memory and bandwidth whenever 16 bits can address every vertex
+    const GLenum indexType = indexTypeFor(vertices.size());
+    if (indexType == GL_UNSIGNED_INT) { return allocate(vertices, std::as_bytes(triangles), indexType); }
+
+    std::vector<GLushort> shortIndices;
+    shortIndices.reserve(3UL * triangles.size());
+    for (const glm::uvec3& triangle : triangles) {
+        for (int vertexIdx = 0; vertexIdx < 3; vertexIdx++) { shortIndices.push_back(static_cast<GLushort>(triangle[vertexIdx])); }
+    }
+    return allocate(vertices, std::as_bytes(std::span<const GLushort>(shortIndices)), indexType);
+}
+
+GeometryAllocation GeometryArena::allocate(std::span<const CompactVertex> vertices, std::span<const std::byte> indices, GLenum indexType) {
+    const size_t indexSize  = indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    const size_t numIndices = indices.size() / indexSize;
+
+    // Find space, growing the buffers if they are too fragmented or full. Index ranges are aligned to their index size
+    std::optional<size_t> vertexOffset = m_vertexAllocator.allocate(vertices.size());
+    if (!vertexOffset.has_value()) {
+        growVertices(m_vertexAllocator.capacity() + vertices.size());
+        vertexOffset = m_vertexAllocator.allocate(vertices.size());
+    }
+    std::optional<size_t> indexOffset = m_indexAllocator.allocate(indices.size(), indexSize);
+    if (!indexOffset.has_value()) {
+        growIndices(m_indexAllocator.capacity() + indices.size() + indexSize);
+        indexOffset = m_indexAllocator.allocate(indices.size(), indexSize);
+    }
+    if (!vertexOffset.has_value() || !indexOffset.has_value()) {
+        throw GeometryArenaException(fmt::format("Failed to allocate {} vertices and {} indices", vertices.size(), numIndices));
+    }
+
+    // Indices stay relative to the mesh; baseVertex offsets them at draw time
+    glNamedBufferSubData(m_vbo, static_cast<GLintptr>(vertexOffset.value() * sizeof(CompactVertex)),
+                         static_cast<GLsizeiptr>(vertices.size_bytes()), vertices.data());
+    glNamedBufferSubData(m_ibo, static_cast<GLintptr>(indexOffset.value()), static_cast<GLsizeiptr>(indices.size()), indices.data());
+
+    return { static_cast<GLint>(vertexOffset.value()),
+             static_cast<GLuint>(vertices.size()),
+             static_cast<GLuint>(indexOffset.value() / indexSize),
+             static_cast<GLsizei>(numIndices),
+             indexType };
+}
+
+void GeometryArena::free(const GeometryAllocation& allocation) {
+    m_vertexAllocator.free(static_cast<size_t>(allocation.baseVertex), allocation.numVertices);
+    m_indexAllocator.free(allocation.indexByteOffset(), static_cast<size_t>(allocation.numIndices) * allocation.indexSize());
+}
+
+void GeometryArena::growBuffer(GLuint& buffer, size_t oldSizeBytes, size_t newSizeBytes) {
+    // Immutable storage cannot be resized, so copy the contents into a new, larger buffer
+    GLuint newBuffer;
+    glCreateBuffers(1, &newBuffer);
+    glNamedBufferStorage(newBuffer, static_cast<GLsizeiptr>(newSizeBytes), nullptr, GL_DYNAMIC_STORAGE_BIT);
+    glCopyNamedBufferSubData(buffer, newBuffer, 0, 0, static_cast<GLsizeiptr>(oldSizeBytes));
+    glDeleteBuffers(1, &buffer);
+    buffer = newBuffer;
+}
+
+void GeometryArena::growVertices(size_t minVertexCapacity) {
+    // Double capacity to amortize the cost of copying
+    const size_t oldCapacity = m_vertexAllocator.capacity();
+    const size_t newCapacity = std::max(2UL * oldCapacity, minVertexCapacity);
+    std::cout << "Growing geometry arena vertex buffer to " << newCapacity << " vertices" << std::endl;
+    growBuffer(m_vbo, oldCapacity * sizeof(CompactVertex), newCapacity * sizeof(CompactVertex));
+    glVertexArrayVertexBuffer(m_vao, 0, m_vbo, 0, sizeof(CompactVertex));
+    m_vertexAllocator.grow(newCapacity);
+}
+
+void GeometryArena::growIndices(size_t minIndexBytes) {
+    const size_t oldCapacity = m_indexAllocator.capacity();
+    const size_t newCapacity = std::max(2UL * oldCapacity, minIndexBytes);
+    std::cout << "Growing geometry arena index buffer to " << newCapacity << " bytes" << std::endl;
+    growBuffer(m_ibo, oldCapacity, newCapacity);
+    glVertexArrayElementBuffer(m_vao, m_ibo);
+    m_indexAllocator.grow(newCapacity);
+}
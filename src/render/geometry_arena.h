@@ -0,0 +1,78 @@
+#ifndef _GEOMETRY_ARENA_H_
+#define _GEOMETRY_ARENA_H_
+
+#include <framework/opengl_includes.h>
+#include <framework/mesh.h>
+
+#include <utils/free_list.hpp>
+#include <utils/vertex_compression.hpp>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <stdint.h>
+
+struct GeometryArenaException : public std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+// Range of the arena buffers owned by a single mesh
+struct GeometryAllocation {
+    GLint baseVertex        { 0 };  // Offset (in vertices) of the mesh's first vertex in the vertex buffer
+    GLuint numVertices      { 0U };
+    GLuint firstIndex       { 0U };  // Offset (in indices of indexType) of the mesh's first index in the index buffer
+    GLsizei numIndices      { 0 };
+    GLenum indexType        { GL_UNSIGNED_INT };  // Small meshes use 16-bit indices (see GeometryArena::indexTypeFor)
+
+    bool valid() const              { return numIndices > 0; }
+    size_t indexSize() const        { return indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint); }
+    size_t indexByteOffset() const  { return firstIndex * indexSize(); }
+};
+
+// Owns one vertex buffer, one index buffer, and the single VAO describing them. All GPU meshes are sub-allocated from it, so
+// switching between meshes needs no VAO or buffer rebinds and meshes can be drawn together with a single multi-draw call.
+// Must be created after the OpenGL context and outlive every GPUMesh; the most recently created arena is the active one
+class GeometryArena {
+public:
+    GeometryArena(size_t initialVertexCapacity, size_t initialIndexBytes);
+    GeometryArena(const GeometryArena&) = delete;
+    ~GeometryArena();
+
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+    static GeometryArena& active();
+
+    // Sub-allocation (buffers grow if there is no free block large enough)
+    GeometryAllocation allocate(std::span<const CompactVertex> vertices, std::span<const glm::uvec3> triangles);
+    GeometryAllocation allocate(std::span<const CompactVertex> vertices, std::span<const std::byte> indices, GLenum indexType); // Indices already in their final type
+    void free(const GeometryAllocation& allocation);
+
+    void bind() const { glBindVertexArray(m_vao); }
+    GLuint getVertexBuffer() const  { return m_vbo; }
+    GLuint getIndexBuffer() const   { return m_ibo; }
+
+private:
+    void initVertexArray();
+    void growBuffer(GLuint& buffer, size_t oldSizeBytes, size_t newSizeBytes);
+    void growVertices(size_t minVertexCapacity);
+    void growIndices(size_t minIndexBytes);
+
+public:
+    // Meshes with at most this many vertices are stored with 16-bit indices
+    static constexpr size_t MAX_SHORT_INDEX_VERTICES = 65536UL;
+    static GLenum indexTypeFor(size_t numVertices) { return numVertices <= MAX_SHORT_INDEX_VERTICES ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT; }
+
+private:
+
+    static constexpr GLuint INVALID = 0xFFFFFFFF;
+    static GeometryArena* s_active;
+
+    GLuint m_vbo { INVALID };
+    GLuint m_ibo { INVALID };
+    GLuint m_vao { INVALID };
+
+    // Allocators work in units of vertices and bytes respectively (index buffer mixes 16- and 32-bit indices)
+    utils::FreeListAllocator m_vertexAllocator;
+    utils::FreeListAllocator m_indexAllocator;
+};
+
+#endif
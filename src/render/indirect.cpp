@@ -0,0 +1,110 @@
+#include "indirect.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/gtc/type_ptr.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <utils/constants.h>
+#include <utils/frustum.hpp>
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+IndirectGeometryBatch::IndirectGeometryBatch() {
+    glCreateBuffers(1, &ssboInstances);
+    glCreateBuffers(1, &ssboVisibleInstances);
+    glCreateBuffers(1, &drawCommandBuffer);
+
+    try {
+        ShaderBuilder frustumCullBuilder;
+        frustumCullBuilder.addStage(GL_COMPUTE_SHADER, utils::SHADERS_DIR_PATH / "deferred" / "frustum_cull.comp");
+        frustumCull = frustumCullBuilder.build();
+    } catch (ShaderLoadingException e) { std::cerr << e.what() << std::endl; }
+}
+
+IndirectGeometryBatch::~IndirectGeometryBatch() {
+    glDeleteBuffers(1, &ssboInstances);
+    glDeleteBuffers(1, &ssboVisibleInstances);
+    glDeleteBuffers(1, &drawCommandBuffer);
+}
+
+void IndirectGeometryBatch::clear() {
+    instances.clear();
+    meshes.clear();
+    instancesPerCommand.clear();
+    commandIndices.clear();
+}
+
+void IndirectGeometryBatch::addInstance(const GPUMesh& mesh, uint32_t materialIdx, const glm::mat4& modelMatrix, const glm::mat3& normalModelMatrix) {
+    // Find draw command responsible for this mesh, creating one if this is the first instance of it
+    auto [commandIter, newCommand] = commandIndices.try_emplace(&mesh, static_cast<uint32_t>(meshes.size()));
+    if (newCommand) {
+        meshes.push_back(&mesh);
+        instancesPerCommand.push_back(0U);
+    }
+    const uint32_t commandIdx = commandIter->second;
+    instancesPerCommand[commandIdx]++;
+
+    instances.push_back({ modelMatrix,
+                          glm::mat4(normalModelMatrix),
+                          glm::vec4(mesh.getBoundsMin(), 1.0f),
+                          glm::vec4(mesh.getBoundsMax(), 1.0f),
+                          glm::uvec4(commandIdx, materialIdx, 0U, 0U) });
+}
+
+void IndirectGeometryBatch::cull(const glm::mat4& viewProjection) {
+    if (instances.empty()) { return; }
+
+    // Commands are grouped by index type (16-bit first) since each multi-draw call reads a single index type
+    std::vector<uint32_t> commandOrder(meshes.size());
+    std::iota(commandOrder.begin(), commandOrder.end(), 0U);
+    std::stable_partition(commandOrder.begin(), commandOrder.end(), [this](uint32_t commandIdx) { return meshes[commandIdx]->indexType() == GL_UNSIGNED_SHORT; });
+    std::vector<uint32_t> sortedCommandIndices(meshes.size());
+    for (uint32_t sortedIdx = 0U; sortedIdx < commandOrder.size(); sortedIdx++) { sortedCommandIndices[commandOrder[sortedIdx]] = sortedIdx; }
+    for (StaticInstanceShader& instance : instances) { instance.drawInfo.x = sortedCommandIndices[instance.drawInfo.x]; }
+    numShortCommands = static_cast<GLsizei>(std::count_if(meshes.begin(), meshes.end(), [](const GPUMesh* mesh) { return mesh->indexType() == GL_UNSIGNED_SHORT; }));
+
+    // Each command gets a contiguous range of the visible instances buffer large enough to hold all of its instances
+    std::vector<DrawElementsIndirectCommand> commands(meshes.size());
+    GLuint baseInstance = 0U;
+    for (size_t sortedIdx = 0UL; sortedIdx < commandOrder.size(); sortedIdx++) {
+        const uint32_t commandIdx   = commandOrder[sortedIdx];
+        const GPUMesh& mesh         = *meshes[commandIdx];
+        commands[sortedIdx]         = { static_cast<GLuint>(mesh.numIndices()), 0U, mesh.firstIndex(), mesh.baseVertex(), baseInstance };
+        baseInstance                += instancesPerCommand[commandIdx];
+    }
+
+    // Upload instance data and reset commands (instance counts are incremented by the culling shader)
+    glNamedBufferData(ssboInstances, sizeof(StaticInstanceShader) * instances.size(), instances.data(), GL_STREAM_DRAW);
+    glNamedBufferData(ssboVisibleInstances, sizeof(GLuint) * instances.size(), nullptr, GL_STREAM_COPY);
+    glNamedBufferData(drawCommandBuffer, sizeof(DrawElementsIndirectCommand) * commands.size(), commands.data(), GL_STREAM_DRAW);
+
+    // Bind buffers and frustum data
+    frustumCull.bind();
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, ssboInstances);           // Bind to binding=2
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, drawCommandBuffer);       // Bind to binding=3
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, ssboVisibleInstances);    // Bind to binding=4
+    const utils::Frustum frustum = utils::Frustum::fromViewProjection(viewProjection);
+    glUniform4fv(0, static_cast<GLsizei>(frustum.planes.size()), glm::value_ptr(frustum.planes[0]));
+    glUniform1ui(6, static_cast<GLuint>(instances.size()));
+
+    // One thread per instance; make results visible to both indirect draws and vertex shader reads
+    const GLuint numWorkgroups = (static_cast<GLuint>(instances.size()) + CULL_WORKGROUP_SIZE - 1U) / CULL_WORKGROUP_SIZE;
+    glDispatchCompute(numWorkgroups, 1U, 1U);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void IndirectGeometryBatch::draw() const {
+    if (instances.empty()) { return; }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, ssboInstances);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, ssboVisibleInstances);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommandBuffer);
+    GeometryArena::active().bind();
+    const GLsizei numIntCommands = static_cast<GLsizei>(meshes.size()) - numShortCommands;
+    if (numShortCommands > 0)   { glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, nullptr, numShortCommands, 0); }
+    if (numIntCommands > 0)     { glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                                              reinterpret_cast<const void*>(numShortCommands * sizeof(DrawElementsIndirectCommand)), numIntCommands, 0); }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
@@ -0,0 +1,73 @@
+#ifndef _INDIRECT_H_
+#define _INDIRECT_H_
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glad/glad.h>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+DISABLE_WARNINGS_POP()
+#include <framework/shader.h>
+
+#include <render/mesh.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+// Layout mandated by glDrawElementsIndirect (https://www.khronos.org/opengl/wiki/Vertex_Rendering#Indirect_rendering)
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// Must match the Instance struct in shaders/deferred/frustum_cull.comp and shaders/deferred/deferred_indirect.vert
+struct StaticInstanceShader {
+    glm::mat4 modelMatrix;
+    glm::mat4 normalModelMatrix;    // Only the upper 3x3 is used; stored as a mat4 to avoid std430 alignment issues
+    glm::vec4 boundsMin;            // Model-space bounding box (W-coordinate is unused)
+    glm::vec4 boundsMax;
+    glm::uvec4 drawInfo;            // X-coordinate is the index of the draw command rendering this instance, Y-coordinate is the material index, ZW are unused
+};
+
+// Collects static mesh instances each frame, frustum culls them in a compute shader, and renders all surviving
+// instances with one multi-draw per index type (one command per distinct mesh; all meshes live in the geometry arena)
+class IndirectGeometryBatch {
+public:
+    IndirectGeometryBatch();
+    ~IndirectGeometryBatch();
+
+    // Instance gathering
+    void clear();
+    void addInstance(const GPUMesh& mesh, uint32_t materialIdx, const glm::mat4& modelMatrix, const glm::mat3& normalModelMatrix);
+    size_t numInstances() const     { return instances.size(); }
+    size_t numDrawCommands() const  { return meshes.size(); }
+
+    // Fill the draw command buffer with the instances inside the given frustum
+    void cull(const glm::mat4& viewProjection);
+
+    // Issue all draw commands with one glMultiDrawElementsIndirect per index type (materials are read per instance)
+    void draw() const;
+
+private:
+    static constexpr GLuint INVALID             = 0xFFFFFFFF;
+    static constexpr GLuint CULL_WORKGROUP_SIZE = 64U;
+
+    // CPU-side data
+    std::vector<StaticInstanceShader> instances;
+    std::vector<const GPUMesh*> meshes;                             // Mesh rendered by each draw command
+    std::vector<GLuint> instancesPerCommand;
+    std::unordered_map<const GPUMesh*, uint32_t> commandIndices;
+    GLsizei numShortCommands { 0 }; // Commands using 16-bit indices come first in the command buffer
+
+    // GPU-side data
+    GLuint ssboInstances        { INVALID };
+    GLuint ssboVisibleInstances { INVALID };
+    GLuint drawCommandBuffer    { INVALID }; // Bound both as an SSBO (written by culling) and as the indirect draw buffer
+    Shader frustumCull;
+};
+
+#endif
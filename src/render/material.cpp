@@ -0,0 +1,323 @@
+#include "material.h"
+
+#include <utils/constants.h>
+#include <algorithm>
+#include <bit>
+
+// Array each of a material's textures lives in (same order as the layers in MaterialShader)
+static constexpr std::array<MaterialTextureType, 6UL> MATERIAL_TEXTURE_TYPES = { MaterialTextureType::Color,  MaterialTextureType::Normal,
+                                                                                 MaterialTextureType::Scalar, MaterialTextureType::Scalar,
+                                                                                 MaterialTextureType::Scalar, MaterialTextureType::Scalar };
+
+static uint32_t numMaterialTextureLevels() { return static_cast<uint32_t>(std::bit_width(static_cast<uint32_t>(utils::MATERIAL_TEXTURE_SIZE))); }
+
+MaterialManager::MaterialManager(const RenderConfig& renderConfig)
+    : m_renderConfig(renderConfig) {
+    for (size_t typeIdx = 0UL; typeIdx < NUM_MATERIAL_TEXTURE_TYPES; typeIdx++) {
+        const MaterialTextureType type  = static_cast<MaterialTextureType>(typeIdx);
+        TextureArrayData& array         = textureArrays[typeIdx];
+        array.format                    = CookedTexture::compressedFormat(type);
+        for (uint32_t level = 0U; level < numMaterialTextureLevels(); level++) {
+            array.layerBytes += CookedTexture::levelByteSize(type, static_cast<uint32_t>(utils::MATERIAL_TEXTURE_SIZE), level);
+        }
+        growArray(array, INITIAL_LAYER_CAPACITY);
+    }
+
+    glCreateBuffers(1, &ssboMaterials);
+}
+
+MaterialManager::~MaterialManager() {
+    for (TextureArrayData& array : textureArrays) { glDeleteTextures(1, &array.texture); }
+    glDeleteBuffers(1, &ssboMaterials);
+}
+
+void MaterialManager::beginFrame() {
+    currentFrame++;
+
+    // Free the layers of textures destroyed since the last frame
+    for (TextureArrayData& array : textureArrays) {
+        for (size_t layer = 0UL; layer < array.layers.size(); layer++) {
+            if (array.layers[layer].address != nullptr && array.layers[layer].texture.expired()) { releaseLayer(array, static_cast<int32_t>(layer)); }
+        }
+    }
+
+    // Coarsest textures first so everything sharpens evenly, ties broken in favour of the most recently drawn
+    std::vector<std::pair<size_t, int32_t>> streamingLayers;
+    for (size_t arrayIdx = 0UL; arrayIdx < textureArrays.size(); arrayIdx++) {
+        const std::vector<LayerData>& layers = textureArrays[arrayIdx].layers;
+        for (size_t layer = 0UL; layer < layers.size(); layer++) {
+            if (layers[layer].address != nullptr && layers[layer].residentLevel > 0U) { streamingLayers.emplace_back(arrayIdx, static_cast<int32_t>(layer)); }
+        }
+    }
+    std::sort(streamingLayers.begin(), streamingLayers.end(), [this](const std::pair<size_t, int32_t>& lhs, const std::pair<size_t, int32_t>& rhs) {
+        const LayerData& lhsLayer = textureArrays[lhs.first].layers[lhs.second];
+        const LayerData& rhsLayer = textureArrays[rhs.first].layers[rhs.second];
+        if (lhsLayer.residentLevel != rhsLayer.residentLevel) { return lhsLayer.residentLevel > rhsLayer.residentLevel; }
+        return lhsLayer.lastUsedFrame > rhsLayer.lastUsedFrame;
+    });
+
+    // One level per texture per frame, within the upload budget (at least one level is always streamed so progress is guaranteed)
+    const size_t uploadBudget   = static_cast<size_t>(std::max(m_renderConfig.textureStreamingKBPerFrame, 0)) * 1024UL;
+    size_t uploadedBytes        = 0UL;
+    for (const auto& [arrayIdx, layer] : streamingLayers) {
+        LayerData& layerData                            = textureArrays[arrayIdx].layers[layer];
+        const std::shared_ptr<const Texture> texture    = layerData.texture.lock();
+        const CookedTexture& cooked                     = layerData.cooked(*texture);
+        const uint32_t nextLevel                        = layerData.residentLevel - 1U;
+        const size_t levelBytes                         = cooked.levels[nextLevel].size();
+        if (uploadedBytes > 0UL && uploadedBytes + levelBytes > uploadBudget) { continue; }
+
+        uploadLevel(textureArrays[arrayIdx], layer, cooked, nextLevel);
+        layerData.residentLevel = nextLevel;
+        uploadedBytes           += levelBytes;
+        for (uint32_t materialIdx : layerData.materials) { updateMaterial(materialIdx); }
+    }
+}
+
+uint32_t MaterialManager::materialIndex(const GPUMesh& mesh) {
+    if (mesh.getMaterialIndex().has_value()) {
+        touch(mesh.getMaterialIndex().value());
+        return mesh.getMaterialIndex().value();
+    }
+
+    // Textures are only locked when the mesh's material changes
+    const std::array<std::weak_ptr<const Texture>, TEXTURES_PER_MATERIAL> textures = { mesh.getAlbedo(), mesh.getNormal(), mesh.getMetallic(),
+                                                                                       mesh.getRoughness(), mesh.getAO(), mesh.getDisplacement() };
+    MaterialKey key { {}, mesh.getIsHeight() };
+    for (size_t textureIdx = 0UL; textureIdx < textures.size(); textureIdx++) { key.first[textureIdx] = textures[textureIdx].lock().get(); }
+
+    // Re-use existing material if another mesh has the same textures. Layers are filled in once the material is made resident.
+    // Entries are keyed by address, so an entry whose textures were freed may match new textures allocated at the same addresses;
+    // such an entry is pointed at a new material (meshes still caching the old index keep drawing it with the defaults)
+    auto [materialIter, newMaterial] = materialIndices.try_emplace(key, static_cast<uint32_t>(materials.size()));
+    if (!newMaterial && !sameTextures(materialData[materialIter->second], key)) {
+        materialIter->second    = static_cast<uint32_t>(materials.size());
+        newMaterial             = true;
+    }
+    if (newMaterial) {
+        MaterialShader material         = uploadedDefaults; // Only the defaults are used, the layers are filled in by updateMaterial()
+        material.displacementIsHeight   = mesh.getIsHeight();
+        materials.push_back(material);
+        materialData.push_back({ textures });
+        updateMaterial(materialIter->second);
+    }
+
+    mesh.setMaterialIndex(materialIter->second);
+    touch(materialIter->second);
+    return materialIter->second;
+}
+
+bool MaterialManager::sameTextures(const MaterialData& material, const MaterialKey& key) {
+    for (size_t textureIdx = 0UL; textureIdx < TEXTURES_PER_MATERIAL; textureIdx++) {
+        if (material.textures[textureIdx].lock().get() != key.first[textureIdx]) { return false; }
+    }
+    return true;
+}
+
+void MaterialManager::bind() {
+    // Default values are shared by all materials, but live in the table so shaders read everything from one place
+    const bool defaultsChanged =   uploadedDefaults.defaultAlbedo       != m_renderConfig.defaultAlbedo      ||
+                                   uploadedDefaults.defaultMetallic     != m_renderConfig.defaultMetallic    ||
+                                   uploadedDefaults.defaultRoughness    != m_renderConfig.defaultRoughness   ||
+                                   uploadedDefaults.defaultAO           != m_renderConfig.defaultAO;
+    if (defaultsChanged) {
+        uploadedDefaults.defaultAlbedo      = m_renderConfig.defaultAlbedo;
+        uploadedDefaults.defaultMetallic    = m_renderConfig.defaultMetallic;
+        uploadedDefaults.defaultRoughness   = m_renderConfig.defaultRoughness;
+        uploadedDefaults.defaultAO          = m_renderConfig.defaultAO;
+        for (MaterialShader& material : materials) {
+            material.defaultAlbedo      = uploadedDefaults.defaultAlbedo;
+            material.defaultMetallic    = uploadedDefaults.defaultMetallic;
+            material.defaultRoughness   = uploadedDefaults.defaultRoughness;
+            material.defaultAO          = uploadedDefaults.defaultAO;
+        }
+        dirtyBegin  = 0UL;
+        dirtyEnd    = materials.size();
+    }
+
+    // Grow the buffer geometrically, so new materials rarely force the whole table to be uploaded again
+    if (materials.size() > ssboCapacity) {
+        ssboCapacity    = std::max<size_t>(materials.size(), 2UL * ssboCapacity);
+        dirtyBegin      = 0UL;
+        dirtyEnd        = materials.size();
+        glNamedBufferData(ssboMaterials, sizeof(MaterialShader) * ssboCapacity, nullptr, GL_DYNAMIC_DRAW);
+    }
+    if (dirtyBegin < dirtyEnd) {
+        glNamedBufferSubData(ssboMaterials, static_cast<GLintptr>(sizeof(MaterialShader) * dirtyBegin),
+                             static_cast<GLsizeiptr>(sizeof(MaterialShader) * (dirtyEnd - dirtyBegin)), &materials[dirtyBegin]);
+        dirtyBegin  = 0UL;
+        dirtyEnd    = 0UL;
+    }
+
+    for (size_t arrayIdx = 0UL; arrayIdx < textureArrays.size(); arrayIdx++) { glBindTextureUnit(static_cast<GLuint>(arrayIdx), textureArrays[arrayIdx].texture); }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, ssboMaterials); // Bind to binding=5
+}
+
+void MaterialManager::touch(uint32_t materialIdx) {
+    // Residency is retried at most once per frame, since failing means every layer is in use by this frame's draws
+    MaterialData& material = materialData[materialIdx];
+    if (!material.resident && material.lastResidencyAttempt != currentFrame) {
+        material.lastResidencyAttempt = currentFrame;
+        makeResident(materialIdx);
+
+        // Materials can become resident mid-pass, so make their layers (and grown arrays) visible to the draw that requested them
+        bind();
+    }
+
+    const MaterialShader& shaderMaterial = materials[materialIdx];
+    const std::array<int32_t, TEXTURES_PER_MATERIAL> layers = { shaderMaterial.albedoLayer, shaderMaterial.normalLayer, shaderMaterial.metallicLayer,
+                                                                shaderMaterial.roughnessLayer, shaderMaterial.aoLayer, shaderMaterial.displacementLayer };
+    for (size_t textureIdx = 0UL; textureIdx < TEXTURES_PER_MATERIAL; textureIdx++) {
+        if (layers[textureIdx] < 0) { continue; }
+        textureArrays[static_cast<size_t>(MATERIAL_TEXTURE_TYPES[textureIdx])].layers[layers[textureIdx]].lastUsedFrame = currentFrame;
+    }
+}
+
+void MaterialManager::makeResident(uint32_t materialIdx) {
+    for (size_t textureIdx = 0UL; textureIdx < TEXTURES_PER_MATERIAL; textureIdx++) {
+        std::shared_ptr<const Texture> texture = materialData[materialIdx].textures[textureIdx].lock();
+        if (!texture) { continue; }
+        const std::optional<int32_t> layer = textureLayer(MATERIAL_TEXTURE_TYPES[textureIdx], texture);
+        if (!layer.has_value()) { continue; }
+
+        std::vector<uint32_t>& layerMaterials = textureArrays[static_cast<size_t>(MATERIAL_TEXTURE_TYPES[textureIdx])].layers[layer.value()].materials;
+        if (std::find(layerMaterials.begin(), layerMaterials.end(), materialIdx) == layerMaterials.end()) { layerMaterials.push_back(materialIdx); }
+    }
+    updateMaterial(materialIdx);
+}
+
+std::optional<int32_t> MaterialManager::textureLayer(MaterialTextureType type, const std::shared_ptr<const Texture>& texture) {
+    // Textures shared by several materials occupy a single layer
+    TextureArrayData& array = textureArrays[static_cast<size_t>(type)];
+    auto layerIter          = array.layerIndices.find(texture.get());
+    if (layerIter != array.layerIndices.end()) {
+        LayerData& existing = array.layers[layerIter->second];
+        if (!existing.texture.expired()) {
+            existing.lastUsedFrame = currentFrame; // Keep it from being evicted for the material's other textures
+            return layerIter->second;
+        }
+
+        // Layer of a destroyed texture whose address was reused before beginFrame() got to free it
+        releaseLayer(array, layerIter->second);
+    }
+
+    const std::optional<int32_t> layer = freeLayer(array);
+    if (!layer.has_value()) { return std::nullopt; }
+    LayerData& layerData    = array.layers[layer.value()];
+    layerData.texture       = texture;
+    layerData.address       = texture.get();
+    layerData.lastUsedFrame = currentFrame;
+    if (!texture->cooked.has_value() || texture->cooked->type != type) {
+        // Texture was not loaded as a material texture of this type, so cook it (or fetch it from the cache) on the spot
+        layerData.converted = loadCookedTexture(texture->sourcePath, type);
+    }
+
+    // Only the small mips are uploaded right away; beginFrame() streams in the rest
+    const CookedTexture& cooked     = layerData.cooked(*texture);
+    const uint32_t numLevels        = static_cast<uint32_t>(cooked.levels.size());
+    const uint32_t initialLevel     = static_cast<uint32_t>(std::bit_width(static_cast<uint32_t>(utils::MATERIAL_TEXTURE_SIZE / utils::MATERIAL_TEXTURE_INITIAL_RESIDENT_SIZE))) - 1U;
+    layerData.residentLevel         = std::min(initialLevel, numLevels - 1U);
+    for (uint32_t level = layerData.residentLevel; level < numLevels; level++) { uploadLevel(array, layer.value(), cooked, level); }
+
+    array.layerIndices[texture.get()] = layer.value();
+    return layer;
+}
+
+std::optional<int32_t> MaterialManager::freeLayer(TextureArrayData& array) {
+    // Reuse a layer left behind by an eviction
+    auto freeIter = std::find_if(array.layers.begin(), array.layers.end(), [](const LayerData& layer) { return layer.address == nullptr; });
+    if (freeIter != array.layers.end()) { return static_cast<int32_t>(std::distance(array.layers.begin(), freeIter)); }
+
+    // Grow the array as far as the budget allows (up to doubling it)
+    const size_t budget         = static_cast<size_t>(std::max(m_renderConfig.materialTextureBudgetMB, 0)) * 1024UL * 1024UL;
+    const size_t allocated      = allocatedBytes();
+    const size_t affordable     = budget > allocated ? (budget - allocated) / array.layerBytes : 0UL;
+    if (affordable > 0UL) {
+        const size_t oldCapacity = array.layers.size();
+        growArray(array, oldCapacity + std::min(oldCapacity, affordable));
+        return static_cast<int32_t>(oldCapacity);
+    }
+
+    // Evict the least recently drawn texture, as long as it was not drawn this frame
+    auto lruIter = std::min_element(array.layers.begin(), array.layers.end(),
+                                    [](const LayerData& lhs, const LayerData& rhs) { return lhs.lastUsedFrame < rhs.lastUsedFrame; });
+    if (lruIter == array.layers.end() || lruIter->lastUsedFrame == currentFrame) { return std::nullopt; }
+    const int32_t layer = static_cast<int32_t>(std::distance(array.layers.begin(), lruIter));
+    releaseLayer(array, layer);
+    return layer;
+}
+
+void MaterialManager::releaseLayer(TextureArrayData& array, int32_t layer) {
+    // Materials sampling the layer fall back to their defaults until they are made resident again
+    array.layerIndices.erase(array.layers[layer].address);
+    const std::vector<uint32_t> layerMaterials = std::move(array.layers[layer].materials);
+    array.layers[layer] = LayerData {};
+    for (uint32_t materialIdx : layerMaterials) { updateMaterial(materialIdx); }
+}
+
+size_t MaterialManager::allocatedBytes() const {
+    size_t totalBytes = 0UL;
+    for (const TextureArrayData& array : textureArrays) { totalBytes += array.layers.size() * array.layerBytes; }
+    return totalBytes;
+}
+
+void MaterialManager::growArray(TextureArrayData& array, size_t newCapacity) {
+    // Texture storage is immutable, so create a larger array and copy every level of the existing layers over
+    const GLsizei numLevels = static_cast<GLsizei>(numMaterialTextureLevels());
+    GLuint newTexture;
+    glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &newTexture);
+    glTextureStorage3D(newTexture, numLevels, array.format, utils::MATERIAL_TEXTURE_SIZE, utils::MATERIAL_TEXTURE_SIZE, static_cast<GLsizei>(newCapacity));
+    glTextureParameteri(newTexture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTextureParameteri(newTexture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTextureParameteri(newTexture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTextureParameteri(newTexture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    if (array.texture != INVALID) {
+        if (!array.layers.empty()) {
+            for (GLint level = 0; level < numLevels; level++) {
+                const GLsizei levelSize = std::max(utils::MATERIAL_TEXTURE_SIZE >> level, 1);
+                glCopyImageSubData(array.texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                                   newTexture, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                                   levelSize, levelSize, static_cast<GLsizei>(array.layers.size()));
+            }
+        }
+        glDeleteTextures(1, &array.texture);
+    }
+    array.texture = newTexture;
+    array.layers.resize(newCapacity);
+}
+
+void MaterialManager::uploadLevel(const TextureArrayData& array, int32_t layer, const CookedTexture& cooked, uint32_t level) {
+    // Cooked textures already hold every mip level in the array's compressed format
+    const std::span<const std::byte> levelData  = cooked.levels[level];
+    const GLsizei levelSize                     = std::max(utils::MATERIAL_TEXTURE_SIZE >> level, 1);
+    glCompressedTextureSubImage3D(array.texture, static_cast<GLint>(level), 0, 0, layer, levelSize, levelSize, 1,
+                                  array.format, static_cast<GLsizei>(levelData.size()), levelData.data());
+}
+
+void MaterialManager::updateMaterial(uint32_t materialIdx) {
+    // Point the material at the current layers (and resident mips) of its textures; textures without a layer fall back to the defaults
+    MaterialShader& material                                        = materials[materialIdx];
+    MaterialData& data                                              = materialData[materialIdx];
+    const std::array<int32_t*, TEXTURES_PER_MATERIAL> layerFields   = { &material.albedoLayer, &material.normalLayer, &material.metallicLayer,
+                                                                        &material.roughnessLayer, &material.aoLayer, &material.displacementLayer };
+    material.packedMinLods  = 0U;
+    data.resident           = true;
+    for (size_t textureIdx = 0UL; textureIdx < TEXTURES_PER_MATERIAL; textureIdx++) {
+        *layerFields[textureIdx]                = -1;
+        std::shared_ptr<const Texture> texture  = data.textures[textureIdx].lock();
+        if (!texture) { continue; }
+
+        const TextureArrayData& array   = textureArrays[static_cast<size_t>(MATERIAL_TEXTURE_TYPES[textureIdx])];
+        auto layerIter                  = array.layerIndices.find(texture.get());
+        if (layerIter == array.layerIndices.end() || array.layers[layerIter->second].texture.expired()) {
+            data.resident = false;
+            continue;
+        }
+        *layerFields[textureIdx]    = layerIter->second;
+        material.packedMinLods      |= array.layers[layerIter->second].residentLevel << (4U * textureIdx);
+    }
+
+    dirtyBegin  = dirtyBegin < dirtyEnd ? std::min(dirtyBegin, static_cast<size_t>(materialIdx)) : materialIdx;
+    dirtyEnd    = std::max(dirtyEnd, static_cast<size_t>(materialIdx) + 1UL);
+}
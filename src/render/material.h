@@ -0,0 +1,125 @@
+#ifndef _MATERIAL_H_
+#define _MATERIAL_H_
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glad/glad.h>
+#include <glm/vec4.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <render/config.h>
+#include <render/mesh.h>
+#include <render/texture.h>
+#include <render/texture_cache.h>
+#include <array>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdint.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Must match the Material struct in shaders/deferred/deferred.frag
+struct MaterialShader {
+    glm::vec4 defaultAlbedo;
+    int32_t albedoLayer;            // Layers are -1 if the material does not have the given texture (or it is not resident)
+    int32_t normalLayer;
+    int32_t metallicLayer;
+    int32_t roughnessLayer;
+    int32_t aoLayer;
+    int32_t displacementLayer;
+    uint32_t displacementIsHeight;
+    float defaultMetallic;
+    float defaultRoughness;
+    float defaultAO;
+    uint32_t packedMinLods;         // 4 bits per texture (same order as the layers): finest mip level resident for that texture
+    float padding;
+};
+
+// Stores every material texture as a layer of one of three texture arrays and every distinct combination of textures as an entry
+// of an SSBO, so that the geometry pass binds its textures once and each draw (or instance) only needs a material index.
+// Layers are managed as a residency cache: a texture only gets a layer once a material using it is drawn, arrays grow until they
+// hit the VRAM budget in the render config, and past that the least recently drawn textures are evicted. New layers start with
+// only their coarse mips resident; finer mips are streamed in a few per frame, coarsest first and most recently drawn first
+class MaterialManager {
+public:
+    MaterialManager(const RenderConfig& renderConfig);
+    ~MaterialManager();
+
+    // Streams in finer mips of resident textures (within the per-frame upload budget); call once per frame before drawing
+    void beginFrame();
+
+    // Index of the mesh's material in the material SSBO; cached on the mesh until one of its textures changes.
+    // Also marks the material's textures as drawn this frame, bringing them back into residency if they were evicted
+    uint32_t materialIndex(const GPUMesh& mesh);
+
+    // Upload the materials changed since the last call and bind the table along with the texture arrays (SSBO binding 5, texture units [0, 2])
+    void bind();
+
+private:
+    static constexpr size_t TEXTURES_PER_MATERIAL = 6UL;
+
+    // Material identity is the exact set of textures it samples (albedo, normal, metallic, roughness, AO, displacement) and the displacement type
+    using MaterialKey = std::pair<std::array<const Texture*, TEXTURES_PER_MATERIAL>, bool>;
+
+    struct MaterialData {
+        std::array<std::weak_ptr<const Texture>, TEXTURES_PER_MATERIAL> textures;
+        bool resident                   { false };  // All of the material's (live) textures have a layer
+        uint64_t lastResidencyAttempt   { 0UL };
+    };
+
+    // Layers do not keep their texture alive; layers of destroyed textures are freed at the start of the next frame
+    struct LayerData {
+        std::weak_ptr<const Texture> texture;
+        const Texture* address { nullptr };         // Key of the layer in layerIndices, null if the layer is free
+        std::optional<CookedTexture> converted;     // Cooked data if the texture was not cooked for this array's type
+        uint32_t residentLevel { 0U };              // Finest mip level uploaded
+        uint64_t lastUsedFrame { 0UL };
+        std::vector<uint32_t> materials;            // Materials sampling the layer, patched whenever it changes
+
+        const CookedTexture& cooked(const Texture& liveTexture) const { return converted.has_value() ? *converted : *liveTexture.cooked; }
+    };
+
+    // One array per material texture type, in that type's block-compressed format
+    struct TextureArrayData {
+        GLuint texture      { INVALID };
+        GLenum format       { GL_COMPRESSED_RGBA_BPTC_UNORM };
+        size_t layerBytes   { 0UL }; // VRAM of one layer with its full mip chain
+        std::vector<LayerData> layers;
+        std::unordered_map<const Texture*, int32_t> layerIndices;
+    };
+
+    static bool sameTextures(const MaterialData& material, const MaterialKey& key); // Whether the material's textures are still alive at the key's addresses
+    void touch(uint32_t materialIdx);
+    void makeResident(uint32_t materialIdx);
+    std::optional<int32_t> textureLayer(MaterialTextureType type, const std::shared_ptr<const Texture>& texture);
+    std::optional<int32_t> freeLayer(TextureArrayData& array);
+    void releaseLayer(TextureArrayData& array, int32_t layer);
+    size_t allocatedBytes() const;
+    void growArray(TextureArrayData& array, size_t newCapacity);
+    void uploadLevel(const TextureArrayData& array, int32_t layer, const CookedTexture& cooked, uint32_t level);
+    void updateMaterial(uint32_t materialIdx);
+
+    static constexpr GLuint INVALID                     = 0xFFFFFFFF;
+    static constexpr size_t INITIAL_LAYER_CAPACITY      = 4UL;
+
+    const RenderConfig& m_renderConfig;
+    uint64_t currentFrame { 1UL };
+
+    // CPU-side materials
+    std::vector<MaterialShader> materials;
+    std::vector<MaterialData> materialData;
+    std::map<MaterialKey, uint32_t> materialIndices;
+    size_t dirtyBegin { 0UL };          // Range of materials changed since the last upload
+    size_t dirtyEnd { 0UL };
+    MaterialShader uploadedDefaults {}; // Default values from the render config at the time of the last upload
+
+    // GPU-side data
+    std::array<TextureArrayData, NUM_MATERIAL_TEXTURE_TYPES> textureArrays;
+    GLuint ssboMaterials    { INVALID };
+    size_t ssboCapacity     { 0UL };     // In materials
+};
+
+#endif
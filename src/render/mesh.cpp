@@ -3,8 +3,12 @@
 #include <framework/mesh.h>
 DISABLE_WARNINGS_PUSH()
 #include <fmt/format.h>
+#include <glm/common.hpp>
+#include <glm/gtx/transform.hpp>
 DISABLE_WARNINGS_POP()
+#include <algorithm>
 #include <iostream>
+#include <utils/mesh_optimizer.hpp>
 #include <vector>
 
 GPUMesh::GPUMesh(std::filesystem::path filePath) {
@@ -21,46 +25,56 @@ GPUMesh::GPUMesh(Mesh& cpuMesh) {
     init(cpuMesh);
 }
 
+GPUMesh::GPUMesh(const CookedMesh& cookedMesh)
+    : m_boundsMin(cookedMesh.boundsMin)
+    , m_boundsMax(cookedMesh.boundsMax) {
+    m_geometry = GeometryArena::active().allocate(cookedMesh.vertices, cookedMesh.indices, cookedMesh.indexType);
+}
+
+GPUMesh::GPUMesh(const CookedMorphMesh& cookedMorphMesh)
+    : GPUMesh(cookedMorphMesh.mesh) {
+    m_numPoses = cookedMorphMesh.numPoses;
+    glCreateBuffers(1, &m_morphTargets);
+    glNamedBufferStorage(m_morphTargets, static_cast<GLsizeiptr>(cookedMorphMesh.poseVertices.size_bytes()), cookedMorphMesh.poseVertices.data(), 0);
+}
+
 void GPUMesh::init(Mesh& cpuMesh) {
-    // Create Element(/Index) Buffer Objects and Vertex Buffer Object.
-    glCreateBuffers(1, &m_ibo);
-    glNamedBufferStorage(m_ibo, static_cast<GLsizeiptr>(cpuMesh.triangles.size() * sizeof(decltype(cpuMesh.triangles)::value_type)), cpuMesh.triangles.data(), 0);
-    glCreateBuffers(1, &m_vbo);
-    glNamedBufferStorage(m_vbo, static_cast<GLsizeiptr>(cpuMesh.vertices.size() * sizeof(decltype(cpuMesh.vertices)::value_type)), cpuMesh.vertices.data(), 0);
-
-    // Bind vertex data to shader inputs using their index (location).
-    // These bindings are stored in the Vertex Array Object.
-    glCreateVertexArrays(1, &m_vao);
-
-    // The indices (pointing to vertices) should be read from the index buffer.
-    glVertexArrayElementBuffer(m_vao, m_ibo);
-
-    // We bind the vertex buffer to slot 0 of the VAO and tell the VBO how large each vertex is (stride).
-    glVertexArrayVertexBuffer(m_vao, 0, m_vbo, 0, sizeof(Vertex));
-
-    // Tell OpenGL that we will be using vertex attributes [0:4]
-    glEnableVertexArrayAttrib(m_vao, 0);
-    glEnableVertexArrayAttrib(m_vao, 1);
-    glEnableVertexArrayAttrib(m_vao, 2);
-    glEnableVertexArrayAttrib(m_vao, 3);
-    glEnableVertexArrayAttrib(m_vao, 4);
-
-    // We tell OpenGL what each vertex looks like and how they are mapped to the shader (location = ...).
-    glVertexArrayAttribFormat(m_vao, 0, 3, GL_FLOAT, false, offsetof(Vertex, position));
-    glVertexArrayAttribFormat(m_vao, 1, 3, GL_FLOAT, false, offsetof(Vertex, normal));
-    glVertexArrayAttribFormat(m_vao, 2, 2, GL_FLOAT, false, offsetof(Vertex, texCoord));
-    glVertexArrayAttribFormat(m_vao, 3, 3, GL_FLOAT, false, offsetof(Vertex, tangent));
-    glVertexArrayAttribFormat(m_vao, 4, 3, GL_FLOAT, false, offsetof(Vertex, bitangent));
-
-    // For each of the vertex attributes we tell OpenGL to get them from VBO at slot 0.
-    glVertexArrayAttribBinding(m_vao, 0, 0);
-    glVertexArrayAttribBinding(m_vao, 1, 0);
-    glVertexArrayAttribBinding(m_vao, 2, 0);
-    glVertexArrayAttribBinding(m_vao, 3, 0);
-    glVertexArrayAttribBinding(m_vao, 4, 0);
-
-    // Each triangle has 3 vertices.
-    m_numIndices = static_cast<GLsizei>(3 * cpuMesh.triangles.size());
+    // Reorder triangles and vertices for the post-transform cache, overdraw, and fetch locality
+    const utils::MeshOptimizationStats optimizationStats = utils::optimizeMesh(cpuMesh);
+    std::cout << fmt::format("Optimized mesh ({} vertices, {} triangles): ACMR {:.3f} -> {:.3f}",
+                             cpuMesh.vertices.size(), cpuMesh.triangles.size(), optimizationStats.acmrBefore, optimizationStats.acmrAfter) << std::endl;
+
+    // Compute model-space bounding box
+    if (!cpuMesh.vertices.empty()) {
+        m_boundsMin = m_boundsMax = cpuMesh.vertices.front().position;
+        for (const Vertex& vertex : cpuMesh.vertices) {
+            m_boundsMin = glm::min(m_boundsMin, vertex.position);
+            m_boundsMax = glm::max(m_boundsMax, vertex.position);
+        }
+    }
+
+    // Quantise vertices (positions relative to the bounding box) and upload them and the indices into the shared buffers
+    std::vector<CompactVertex> compactVertices;
+    compactVertices.reserve(cpuMesh.vertices.size());
+    for (const Vertex& vertex : cpuMesh.vertices) { compactVertices.push_back(utils::compressVertex(vertex, m_boundsMin, m_boundsMax)); }
+    m_geometry = GeometryArena::active().allocate(compactVertices, cpuMesh.triangles);
+}
+
+glm::mat4 GPUMesh::dequantizationMatrix() const {
+    return glm::translate(m_boundsMin) * glm::scale(utils::positionScale(m_boundsMin, m_boundsMax));
+}
+
+void GPUMesh::bindMorphTargets() const {
+    // Same locations in every shader drawing GPU meshes (shaders/deferred/deferred.vert and the shadow vertex shaders)
+    glUniform1i(13, m_morphTargets != INVALID);
+    if (m_morphTargets == INVALID) { return; }
+
+    const float pose            = glm::clamp(m_pose, 0.0f, static_cast<float>(m_numPoses - 1U));
+    const uint32_t firstPose    = std::min(static_cast<uint32_t>(pose), m_numPoses - 1U);
+    const uint32_t secondPose   = std::min(firstPose + 1U, m_numPoses - 1U);
+    glUniform2ui(14, firstPose * m_geometry.numVertices, secondPose * m_geometry.numVertices);
+    glUniform1f(15, pose - static_cast<float>(firstPose));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, m_morphTargets); // Bind to binding=6
 }
 
 GPUMesh::GPUMesh(GPUMesh&& other) { moveInto(std::move(other)); }
@@ -73,16 +87,19 @@ GPUMesh& GPUMesh::operator=(GPUMesh&& other) {
 }
 
 void GPUMesh::draw() const {
-    glBindVertexArray(m_vao);
-    glDrawElements(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, nullptr);
+    GeometryArena::active().bind();
+    glDrawElementsBaseVertex(GL_TRIANGLES, m_geometry.numIndices, m_geometry.indexType,
+                             reinterpret_cast<const void*>(m_geometry.indexByteOffset()), m_geometry.baseVertex);
 }
 
 void GPUMesh::moveInto(GPUMesh&& other) {
     freeGpuMemory();
-    m_numIndices    = other.m_numIndices;
-    m_ibo           = other.m_ibo;
-    m_vbo           = other.m_vbo;
-    m_vao           = other.m_vao;
+    m_geometry      = other.m_geometry;
+    m_boundsMin     = other.m_boundsMin;
+    m_boundsMax     = other.m_boundsMax;
+    m_morphTargets  = other.m_morphTargets;
+    m_numPoses      = other.m_numPoses;
+    m_pose          = other.m_pose;
     m_albedo        = other.m_albedo;
     m_normal        = other.m_normal;
     m_metallic      = other.m_metallic;
@@ -90,11 +107,10 @@ void GPUMesh::moveInto(GPUMesh&& other) {
     m_ao            = other.m_ao;
     m_displacement  = other.m_displacement;
     isHeight        = other.isHeight;
+    m_materialIdx   = other.m_materialIdx;
 
-    other.m_numIndices      = 0;
-    other.m_ibo             = INVALID;
-    other.m_vbo             = INVALID;
-    other.m_vao             = INVALID;
+    other.m_geometry        = GeometryAllocation();
+    other.m_morphTargets    = INVALID;
     other.m_albedo          = std::weak_ptr<Texture>();
     other.m_normal          = std::weak_ptr<Texture>();
     other.m_metallic        = std::weak_ptr<Texture>();
@@ -105,7 +121,12 @@ void GPUMesh::moveInto(GPUMesh&& other) {
 }
 
 void GPUMesh::freeGpuMemory() {
-    if (m_vao != INVALID) { glDeleteVertexArrays(1, &m_vao); }
-    if (m_vbo != INVALID) { glDeleteBuffers(1, &m_vbo); }
-    if (m_ibo != INVALID) { glDeleteBuffers(1, &m_ibo); }
+    if (m_geometry.valid()) {
+        GeometryArena::active().free(m_geometry);
+        m_geometry = GeometryAllocation();
+    }
+    if (m_morphTargets != INVALID) {
+        glDeleteBuffers(1, &m_morphTargets);
+        m_morphTargets = INVALID;
+    }
 }
@@ -2,11 +2,20 @@
 #define _MESH_H_
 
 #include <framework/opengl_includes.h>
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+DISABLE_WARNINGS_POP()
 
+#include <render/geometry_arena.h>
+#include <render/mesh_cache.h>
 #include <render/texture.h>
 #include <exception>
 #include <filesystem>
 #include <memory>
+#include <optional>
+#include <stdint.h>
 #include "framework/mesh.h"
 
 struct MeshLoadingException : public std::runtime_error {
@@ -17,6 +26,8 @@ class GPUMesh {
 public:
     GPUMesh(std::filesystem::path filePath);
     GPUMesh(Mesh& cpuMesh);
+    GPUMesh(const CookedMesh& cookedMesh); // Uploads cooked data as-is
+    GPUMesh(const CookedMorphMesh& cookedMorphMesh); // First pose as regular geometry, every pose into a morph target buffer
     GPUMesh(const GPUMesh&) = delete; // Cannot copy a GPU mesh because it would require reference counting of GPU resources.
     GPUMesh(GPUMesh&&);
     ~GPUMesh();
@@ -25,9 +36,28 @@ public:
     GPUMesh& operator=(const GPUMesh&) = delete;
     GPUMesh& operator=(GPUMesh&&);
 
-    // Bind VAO and call glDrawElements.
+    // Bind the shared arena VAO and call glDrawElementsBaseVertex on this mesh's range.
     void draw() const;
 
+    // Geometry info (bounds are in model space)
+    GLsizei numIndices() const                                                      { return m_geometry.numIndices; }
+    GLuint firstIndex() const                                                       { return m_geometry.firstIndex; }
+    GLint baseVertex() const                                                        { return m_geometry.baseVertex; }
+    GLenum indexType() const                                                        { return m_geometry.indexType; }
+    const glm::vec3& getBoundsMin() const                                           { return m_boundsMin; }
+    const glm::vec3& getBoundsMax() const                                           { return m_boundsMax; }
+
+    // Vertex positions are stored quantised to the bounding box; this maps them back to model space
+    glm::mat4 dequantizationMatrix() const;
+
+    // Morph target animation (meshes loaded from a CookedMorphMesh). The pose is fractional: the vertex shader blends the two
+    // nearest poses. Morphing meshes must not be static, since the indirect static geometry path only draws the first pose
+    uint32_t numPoses() const                                                       { return m_numPoses; }
+    void setPose(float pose)                                                        { m_pose = pose; }
+
+    // Set morph uniforms (locations 13-15) of the bound shader and bind the pose buffer (SSBO binding 6); disables morphing for other meshes
+    void bindMorphTargets() const;
+
     // Getters and setters for textures
     std::weak_ptr<const Texture> getAlbedo() const                                  { return m_albedo; }
     std::weak_ptr<const Texture> getNormal() const                                  { return m_normal; }
@@ -36,13 +66,23 @@ public:
     std::weak_ptr<const Texture> getAO() const                                      { return m_ao; }
     std::weak_ptr<const Texture> getDisplacement() const                            { return m_displacement; }
     bool getIsHeight() const                                                        { return isHeight; }
-    void setAlbedo(std::weak_ptr<const Texture> newALbedo)                          { m_albedo          = newALbedo; }
-    void setNormal(std::weak_ptr<const Texture> newNormal)                          { m_normal          = newNormal; }
-    void setMetallic(std::weak_ptr<const Texture> newMetallic)                      { m_metallic        = newMetallic; }
-    void setRoughness(std::weak_ptr<const Texture> newRoughness)                    { m_roughness       = newRoughness; }
-    void setAO(std::weak_ptr<const Texture> newAO)                                  { m_ao              = newAO; }
+    void setAlbedo(std::weak_ptr<const Texture> newALbedo)                          { m_albedo          = newALbedo;
+                                                                                      m_materialIdx     = std::nullopt; }
+    void setNormal(std::weak_ptr<const Texture> newNormal)                          { m_normal          = newNormal;
+                                                                                      m_materialIdx     = std::nullopt; }
+    void setMetallic(std::weak_ptr<const Texture> newMetallic)                      { m_metallic        = newMetallic;
+                                                                                      m_materialIdx     = std::nullopt; }
+    void setRoughness(std::weak_ptr<const Texture> newRoughness)                    { m_roughness       = newRoughness;
+                                                                                      m_materialIdx     = std::nullopt; }
+    void setAO(std::weak_ptr<const Texture> newAO)                                  { m_ao              = newAO;
+                                                                                      m_materialIdx     = std::nullopt; }
     void setDisplacement(std::weak_ptr<const Texture> newDisplacement, bool height) { m_displacement    = newDisplacement; 
-                                                                                      isHeight          = height;  }
+                                                                                      isHeight          = height;
+                                                                                      m_materialIdx     = std::nullopt; }
+
+    // Index into the material table (see MaterialManager), cached here so textures need not be locked every draw
+    std::optional<uint32_t> getMaterialIndex() const                                { return m_materialIdx; }
+    void setMaterialIndex(uint32_t materialIdx) const                               { m_materialIdx = materialIdx; }
 
 private:
     void moveInto(GPUMesh&&);
@@ -50,13 +90,18 @@ private:
     void init(Mesh& cpuMesh);
 
 private:
-    static constexpr GLuint INVALID = 0xFFFFFFFF;
+    // Range of the shared vertex and index buffers holding this mesh
+    GeometryAllocation m_geometry;
 
-    // Indices, vertices, and VAO
-    GLsizei m_numIndices { 0 };
-    GLuint m_ibo { INVALID };
-    GLuint m_vbo { INVALID };
-    GLuint m_vao { INVALID };
+    // Axis-aligned bounding box of all vertices (used for culling)
+    glm::vec3 m_boundsMin { 0.0f };
+    glm::vec3 m_boundsMax { 0.0f };
+
+    // Morph targets (every pose's MorphVertex array, pose by pose)
+    static constexpr GLuint INVALID = 0xFFFFFFFF;
+    GLuint m_morphTargets   { INVALID };
+    uint32_t m_numPoses     { 1U };
+    float m_pose            { 0.0f };
 
     // Texture data
     std::weak_ptr<const Texture> m_albedo       { std::weak_ptr<Texture>() };
@@ -66,6 +111,7 @@ private:
     std::weak_ptr<const Texture> m_ao           { std::weak_ptr<Texture>() };
     std::weak_ptr<const Texture> m_displacement { std::weak_ptr<Texture>() };
     bool isHeight { true }; // True if given map is a height map (black indicates recessed regions), false if depth map (black indicates elevated regions)
+    mutable std::optional<uint32_t> m_materialIdx;
 };
 
 #endif
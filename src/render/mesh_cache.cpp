@@ -0,0 +1,309 @@
+#include "mesh_cache.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <fmt/format.h>
+#include <glm/common.hpp>
+DISABLE_WARNINGS_POP()
+#include <framework/mesh.h>
+
+#include <render/geometry_arena.h>
+#include <render/mesh.h>
+#include <utils/cache_file.hpp>
+#include <utils/constants.h>
+#include <utils/mesh_optimizer.hpp>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <vector>
+
+// Bump whenever the vertex layout, optimisation pipeline, or file layout changes so that stale cache entries are rebuilt
+static constexpr uint32_t COOKED_MESH_MAGIC     = 0x48534D4D; // "MMSH"
+static constexpr uint32_t COOKED_MESH_VERSION   = 1U;
+
+// File layout: header, then vertices, then indices. The header is padded so both arrays are suitably aligned in the mapping
+struct CookedMeshHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceHash;
+    uint32_t numVertices;
+    uint32_t numIndices;
+    uint32_t indexType;
+    float boundsMin[3];
+    float boundsMax[3];
+    uint32_t padding[3];
+};
+static_assert(sizeof(CookedMeshHeader) == 64UL);
+
+// Morph meshes extend the mesh layout: header, vertices (first pose), indices padded to 4 bytes, then every pose's vertices
+static constexpr uint32_t COOKED_MORPH_MESH_MAGIC = 0x50524D4D; // "MMRP"
+struct CookedMorphMeshHeader {
+    CookedMeshHeader mesh;  // Bounds cover every pose
+    uint32_t numPoses;
+    float restBoundsMin[3]; // Bounds of the first pose alone
+    float restBoundsMax[3];
+    uint32_t padding;
+};
+static_assert(sizeof(CookedMorphMeshHeader) == 96UL);
+
+static std::filesystem::path cachePath(uint64_t sourceHash, std::string_view extension) {
+    return utils::RESOURCES_DIR_PATH / "cache" / fmt::format("{:016x}.{}", sourceHash, extension);
+}
+
+static size_t indexSizeOf(GLenum indexType) { return indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint); }
+
+static size_t morphPosesOffset(const CookedMeshHeader& header) {
+    const size_t indicesEnd = sizeof(CookedMorphMeshHeader) + header.numVertices * sizeof(CompactVertex) + header.numIndices * indexSizeOf(header.indexType);
+    return (indicesEnd + 3UL) & ~3UL;
+}
+
+// Source hash is checked separately, since bundled meshes are matched by path instead
+static bool validCookedMesh(std::span<const std::byte> bytes) {
+    if (bytes.size() < sizeof(CookedMeshHeader)) { return false; }
+    const CookedMeshHeader& header  = *reinterpret_cast<const CookedMeshHeader*>(bytes.data());
+    const size_t expectedSize       = sizeof(CookedMeshHeader) + header.numVertices * sizeof(CompactVertex) + header.numIndices * indexSizeOf(header.indexType);
+    return header.magic == COOKED_MESH_MAGIC && header.version == COOKED_MESH_VERSION && bytes.size() == expectedSize;
+}
+
+static bool validCookedMorphMesh(std::span<const std::byte> bytes) {
+    if (bytes.size() < sizeof(CookedMorphMeshHeader)) { return false; }
+    const CookedMorphMeshHeader& header = *reinterpret_cast<const CookedMorphMeshHeader*>(bytes.data());
+    const size_t expectedSize           = morphPosesOffset(header.mesh) + static_cast<size_t>(header.numPoses) * header.mesh.numVertices * sizeof(MorphVertex);
+    return header.mesh.magic == COOKED_MORPH_MESH_MAGIC && header.mesh.version == COOKED_MESH_VERSION && header.numPoses > 0U && bytes.size() == expectedSize;
+}
+
+static bool validCookedMesh(const MappedFile& file, uint64_t sourceHash, bool morph) {
+    const bool validLayout = morph ? validCookedMorphMesh(file.bytes()) : validCookedMesh(file.bytes());
+    return validLayout && reinterpret_cast<const CookedMeshHeader*>(file.bytes().data())->sourceHash == sourceHash;
+}
+
+// Point spans straight into the mapping
+static CookedMesh viewCookedMesh(std::shared_ptr<const MappedFile> file, std::span<const std::byte> bytes, size_t headerSize = sizeof(CookedMeshHeader)) {
+    const std::byte* data           = bytes.data();
+    const CookedMeshHeader& header  = *reinterpret_cast<const CookedMeshHeader*>(data);
+    const std::byte* vertexData     = data + headerSize;
+    const std::byte* indexData      = vertexData + header.numVertices * sizeof(CompactVertex);
+
+    CookedMesh cooked;
+    cooked.vertices     = { reinterpret_cast<const CompactVertex*>(vertexData), header.numVertices };
+    cooked.indices      = { indexData, header.numIndices * indexSizeOf(header.indexType) };
+    cooked.indexType    = header.indexType;
+    cooked.boundsMin    = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    cooked.boundsMax    = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+    cooked.file         = std::move(file);
+    return cooked;
+}
+
+static CookedMorphMesh viewCookedMorphMesh(std::shared_ptr<const MappedFile> file, std::span<const std::byte> bytes) {
+    const CookedMorphMeshHeader& header = *reinterpret_cast<const CookedMorphMeshHeader*>(bytes.data());
+    CookedMorphMesh cooked;
+    cooked.numPoses         = header.numPoses;
+    cooked.poseVertices     = { reinterpret_cast<const MorphVertex*>(bytes.data() + morphPosesOffset(header.mesh)),
+                                static_cast<size_t>(header.numPoses) * header.mesh.numVertices };
+    cooked.restBoundsMin    = glm::vec3(header.restBoundsMin[0], header.restBoundsMin[1], header.restBoundsMin[2]);
+    cooked.restBoundsMax    = glm::vec3(header.restBoundsMax[0], header.restBoundsMax[1], header.restBoundsMax[2]);
+    cooked.mesh             = viewCookedMesh(std::move(file), bytes, sizeof(CookedMorphMeshHeader));
+    return cooked;
+}
+
+static void computeBounds(std::span<const Vertex> vertices, glm::vec3& boundsMin, glm::vec3& boundsMax) {
+    boundsMin = boundsMax = glm::vec3(0.0f);
+    if (vertices.empty()) { return; }
+    boundsMin = boundsMax = vertices.front().position;
+    for (const Vertex& vertex : vertices) {
+        boundsMin = glm::min(boundsMin, vertex.position);
+        boundsMax = glm::max(boundsMax, vertex.position);
+    }
+}
+
+static void fillHeader(CookedMeshHeader& header, uint32_t magic, uint64_t sourceHash, const Mesh& cpuMesh, const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    header.magic        = magic;
+    header.version      = COOKED_MESH_VERSION;
+    header.sourceHash   = sourceHash;
+    header.numVertices  = static_cast<uint32_t>(cpuMesh.vertices.size());
+    header.numIndices   = static_cast<uint32_t>(3UL * cpuMesh.triangles.size());
+    header.indexType    = GeometryArena::indexTypeFor(cpuMesh.vertices.size());
+    for (int axis = 0; axis < 3; axis++) {
+        header.boundsMin[axis] = boundsMin[axis];
+        header.boundsMax[axis] = boundsMax[axis];
+    }
+}
+
+static void writeIndices(std::ofstream& output, const std::vector<glm::uvec3>& triangles, GLenum indexType) {
+    if (indexType == GL_UNSIGNED_SHORT) {
+        std::vector<GLushort> shortIndices;
+        shortIndices.reserve(3UL * triangles.size());
+        for (const glm::uvec3& triangle : triangles) {
+            for (int vertexIdx = 0; vertexIdx < 3; vertexIdx++) { shortIndices.push_back(static_cast<GLushort>(triangle[vertexIdx])); }
+        }
+        output.write(reinterpret_cast<const char*>(shortIndices.data()), static_cast<std::streamsize>(shortIndices.size() * sizeof(GLushort)));
+    } else {
+        output.write(reinterpret_cast<const char*>(triangles.data()), static_cast<std::streamsize>(triangles.size() * sizeof(glm::uvec3)));
+    }
+}
+
+static void cookMesh(const std::filesystem::path& objPath, const std::filesystem::path& cookedPath, uint64_t sourceHash) {
+    // Same pipeline GPUMesh applies to CPU meshes, done once and stored
+    Mesh cpuMesh = mergeMeshes(loadMesh(objPath));
+    utils::optimizeMesh(cpuMesh);
+    glm::vec3 boundsMin, boundsMax;
+    computeBounds(cpuMesh.vertices, boundsMin, boundsMax);
+    std::vector<CompactVertex> vertices;
+    vertices.reserve(cpuMesh.vertices.size());
+    for (const Vertex& vertex : cpuMesh.vertices) { vertices.push_back(utils::compressVertex(vertex, boundsMin, boundsMax)); }
+
+    CookedMeshHeader header {};
+    fillHeader(header, COOKED_MESH_MAGIC, sourceHash, cpuMesh, boundsMin, boundsMax);
+    const std::filesystem::path tempPath = utils::tempCachePath(cookedPath);
+    {
+        std::ofstream output(tempPath, std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        output.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(vertices.size() * sizeof(CompactVertex)));
+        writeIndices(output, cpuMesh.triangles, header.indexType);
+        if (!output) { throw MeshLoadingException(fmt::format("Failed to write cooked mesh {}", cookedPath.string())); }
+    }
+    std::filesystem::rename(tempPath, cookedPath);
+}
+
+static void cookMorphMesh(std::span<const std::filesystem::path> posePaths, const std::filesystem::path& cookedPath, uint64_t sourceHash) {
+    std::vector<Mesh> poses;
+    for (const std::filesystem::path& posePath : posePaths) {
+        poses.push_back(mergeMeshes(loadMesh(posePath)));
+        if (poses.back().triangles.size() != poses.front().triangles.size()) {
+            throw MeshLoadingException(fmt::format("Pose {} does not have the same triangles as {}", posePath.string(), posePaths.front().string()));
+        }
+    }
+
+    // Poses are exports of the same mesh, so triangles and their corners come in the same order in every pose. Each pose is
+    // deduplicated separately though (corners sharing a vertex in one pose may not in another), so a morph vertex is a distinct
+    // combination of the vertices a corner uses across all poses
+    Mesh baseMesh;
+    baseMesh.material = poses.front().material;
+    std::vector<std::vector<Vertex>> poseVertices(poses.size());
+    std::map<std::vector<uint32_t>, uint32_t> morphVertexIndices;
+    std::vector<uint32_t> cornerVertices(poses.size());
+    for (size_t triangleIdx = 0UL; triangleIdx < poses.front().triangles.size(); triangleIdx++) {
+        glm::uvec3 triangle;
+        for (int corner = 0; corner < 3; corner++) {
+            for (size_t poseIdx = 0UL; poseIdx < poses.size(); poseIdx++) { cornerVertices[poseIdx] = poses[poseIdx].triangles[triangleIdx][corner]; }
+            auto [vertexIter, newVertex] = morphVertexIndices.try_emplace(cornerVertices, static_cast<uint32_t>(baseMesh.vertices.size()));
+            if (newVertex) {
+                baseMesh.vertices.push_back(poses.front().vertices[cornerVertices.front()]);
+                for (size_t poseIdx = 0UL; poseIdx < poses.size(); poseIdx++) { poseVertices[poseIdx].push_back(poses[poseIdx].vertices[cornerVertices[poseIdx]]); }
+            }
+            triangle[corner] = vertexIter->second;
+        }
+        baseMesh.triangles.push_back(triangle);
+    }
+
+    // Optimise the first pose and apply the same vertex order to the others
+    std::vector<uint32_t> vertexRemap;
+    utils::optimizeMesh(baseMesh, &vertexRemap);
+    for (std::vector<Vertex>& vertices : poseVertices) {
+        std::vector<Vertex> reordered(baseMesh.vertices.size());
+        for (size_t oldIdx = 0UL; oldIdx < vertices.size(); oldIdx++) {
+            if (vertexRemap[oldIdx] != utils::UNMAPPED_VERTEX) { reordered[vertexRemap[oldIdx]] = vertices[oldIdx]; }
+        }
+        vertices = std::move(reordered);
+    }
+
+    // All poses are quantised to the same box, so the shader can blend them before dequantising
+    glm::vec3 boundsMin, boundsMax, restBoundsMin, restBoundsMax;
+    computeBounds(baseMesh.vertices, restBoundsMin, restBoundsMax);
+    boundsMin = restBoundsMin;
+    boundsMax = restBoundsMax;
+    for (const std::vector<Vertex>& vertices : poseVertices) {
+        glm::vec3 poseBoundsMin, poseBoundsMax;
+        computeBounds(vertices, poseBoundsMin, poseBoundsMax);
+        boundsMin = glm::min(boundsMin, poseBoundsMin);
+        boundsMax = glm::max(boundsMax, poseBoundsMax);
+    }
+    std::vector<CompactVertex> vertices;
+    vertices.reserve(baseMesh.vertices.size());
+    for (const Vertex& vertex : baseMesh.vertices) { vertices.push_back(utils::compressVertex(vertex, boundsMin, boundsMax)); }
+    std::vector<MorphVertex> morphVertices;
+    morphVertices.reserve(poseVertices.size() * baseMesh.vertices.size());
+    for (const std::vector<Vertex>& pose : poseVertices) {
+        for (const Vertex& vertex : pose) { morphVertices.push_back(utils::compressMorphVertex(vertex, boundsMin, boundsMax)); }
+    }
+
+    CookedMorphMeshHeader header {};
+    fillHeader(header.mesh, COOKED_MORPH_MESH_MAGIC, sourceHash, baseMesh, boundsMin, boundsMax);
+    header.numPoses = static_cast<uint32_t>(poses.size());
+    for (int axis = 0; axis < 3; axis++) {
+        header.restBoundsMin[axis] = restBoundsMin[axis];
+        header.restBoundsMax[axis] = restBoundsMax[axis];
+    }
+    const std::filesystem::path tempPath = utils::tempCachePath(cookedPath);
+    {
+        std::ofstream output(tempPath, std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        output.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(vertices.size() * sizeof(CompactVertex)));
+        writeIndices(output, baseMesh.triangles, header.mesh.indexType);
+        const size_t indicesEnd = sizeof(header) + vertices.size() * sizeof(CompactVertex) + header.mesh.numIndices * indexSizeOf(header.mesh.indexType);
+        output.write("\0\0\0", static_cast<std::streamsize>(morphPosesOffset(header.mesh) - indicesEnd));
+        output.write(reinterpret_cast<const char*>(morphVertices.data()), static_cast<std::streamsize>(morphVertices.size() * sizeof(MorphVertex)));
+        if (!output) { throw MeshLoadingException(fmt::format("Failed to write cooked mesh {}", cookedPath.string())); }
+    }
+    std::filesystem::rename(tempPath, cookedPath);
+}
+
+CookedMesh loadCookedMesh(const std::filesystem::path& objPath) {
+    if (!std::filesystem::exists(objPath)) { throw MeshLoadingException(fmt::format("File {} does not exist", objPath.string())); }
+
+    // Hashing the source is far cheaper than parsing it, and catches any edit to the file
+    const uint64_t sourceHash                   = utils::fnv1a64(MappedFile(objPath).bytes());
+    const std::filesystem::path cookedPath      = cachePath(sourceHash, "mesh");
+    MappedFile cookedFile;
+    if (std::filesystem::exists(cookedPath)) { cookedFile = MappedFile(cookedPath); }
+    if (!validCookedMesh(cookedFile, sourceHash, false)) {
+        std::cout << fmt::format("Cooking {}\n", objPath.filename().string()) << std::flush; // Single write so concurrent loads do not interleave
+        cookMesh(objPath, cookedPath, sourceHash);
+        cookedFile = MappedFile(cookedPath);
+        if (!validCookedMesh(cookedFile, sourceHash, false)) { throw MeshLoadingException(fmt::format("Cooked mesh {} is invalid", cookedPath.string())); }
+    }
+
+    // Moving the mapping does not move the mapped memory, so the spans stay valid
+    auto sharedFile = std::make_shared<const MappedFile>(std::move(cookedFile));
+    return viewCookedMesh(sharedFile, sharedFile->bytes());
+}
+
+CookedMesh loadCookedMesh(const std::filesystem::path& objPath, AssetBundle& assetBundle) {
+    const std::optional<BundledAsset> bundled = assetBundle.find(objPath, AssetFormat::Mesh);
+    if (bundled.has_value() && validCookedMesh(bundled->bytes)) { return viewCookedMesh(bundled->file, bundled->bytes); }
+
+    CookedMesh cooked = loadCookedMesh(objPath);
+    assetBundle.add(objPath, AssetFormat::Mesh, { cooked.file, cooked.file->bytes() });
+    return cooked;
+}
+
+CookedMorphMesh loadCookedMorphMesh(std::span<const std::filesystem::path> posePaths) {
+    if (posePaths.empty()) { throw MeshLoadingException("Morph meshes need at least one pose"); }
+    uint64_t sourceHash = utils::fnv1a64({});
+    for (const std::filesystem::path& posePath : posePaths) {
+        if (!std::filesystem::exists(posePath)) { throw MeshLoadingException(fmt::format("File {} does not exist", posePath.string())); }
+        sourceHash = utils::fnv1a64(MappedFile(posePath).bytes(), sourceHash);
+    }
+
+    const std::filesystem::path cookedPath = cachePath(sourceHash, "morph");
+    MappedFile cookedFile;
+    if (std::filesystem::exists(cookedPath)) { cookedFile = MappedFile(cookedPath); }
+    if (!validCookedMesh(cookedFile, sourceHash, true)) {
+        std::cout << fmt::format("Cooking {} poses of {}\n", posePaths.size(), posePaths.front().filename().string()) << std::flush;
+        cookMorphMesh(posePaths, cookedPath, sourceHash);
+        cookedFile = MappedFile(cookedPath);
+        if (!validCookedMesh(cookedFile, sourceHash, true)) { throw MeshLoadingException(fmt::format("Cooked mesh {} is invalid", cookedPath.string())); }
+    }
+
+    auto sharedFile = std::make_shared<const MappedFile>(std::move(cookedFile));
+    return viewCookedMorphMesh(sharedFile, sharedFile->bytes());
+}
+
+CookedMorphMesh loadCookedMorphMesh(std::span<const std::filesystem::path> posePaths, AssetBundle& assetBundle) {
+    const std::optional<BundledAsset> bundled = assetBundle.find(posePaths, AssetFormat::MorphMesh);
+    if (bundled.has_value() && validCookedMorphMesh(bundled->bytes)) { return viewCookedMorphMesh(bundled->file, bundled->bytes); }
+
+    CookedMorphMesh cooked = loadCookedMorphMesh(posePaths);
+    assetBundle.add(posePaths, AssetFormat::MorphMesh, { cooked.mesh.file, cooked.mesh.file->bytes() });
+    return cooked;
+}
@@ -0,0 +1,56 @@
+#ifndef _MESH_CACHE_H_
+#define _MESH_CACHE_H_
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glad/glad.h>
+#include <glm/vec3.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <render/asset_bundle.h>
+#include <utils/hitbox.hpp>
+#include <utils/mapped_file.hpp>
+#include <utils/vertex_compression.hpp>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <stdint.h>
+
+// Mesh in its final GPU format (optimised, quantised, and with indices in their final type), viewed directly from a memory-mapped
+// cache file or asset bundle
+struct CookedMesh {
+    std::shared_ptr<const MappedFile> file;
+    std::span<const CompactVertex> vertices;
+    std::span<const std::byte> indices;
+    GLenum indexType;
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+
+    HitBox makeHitBox(bool allowCollision) const { return HitBox::makeHitBox(boundsMin, boundsMax, allowCollision); }
+};
+
+// Vertex animation cooked from one OBJ per pose of the same mesh: the first pose as a regular mesh plus every pose's positions and
+// normals for the vertex shader to blend between (see GPUMesh::setPose)
+struct CookedMorphMesh {
+    CookedMesh mesh;                                // First pose, quantised to bounds covering every pose
+    uint32_t numPoses;
+    std::span<const MorphVertex> poseVertices;      // numPoses * numVertices, pose by pose in the mesh's vertex order
+    glm::vec3 restBoundsMin;                        // Bounds of the first pose alone
+    glm::vec3 restBoundsMax;
+
+    HitBox makeHitBox(bool allowCollision) const { return HitBox::makeHitBox(restBoundsMin, restBoundsMax, allowCollision); }
+};
+
+// Loads an OBJ file through the cooked mesh cache (resources/cache). On a miss (no cooked file for the source file's current
+// contents) the OBJ is parsed, merged, optimised, and quantised once and the result is written to the cache
+[[nodiscard]] CookedMesh loadCookedMesh(const std::filesystem::path& objPath);
+
+// Same as above, but served from the asset bundle when it holds an up-to-date copy (anything loaded otherwise is added to it)
+[[nodiscard]] CookedMesh loadCookedMesh(const std::filesystem::path& objPath, AssetBundle& assetBundle);
+
+// Loads the poses of a vertex animation through the cooked mesh cache (see above). All poses must share the same triangles
+[[nodiscard]] CookedMorphMesh loadCookedMorphMesh(std::span<const std::filesystem::path> posePaths);
+[[nodiscard]] CookedMorphMesh loadCookedMorphMesh(std::span<const std::filesystem::path> posePaths, AssetBundle& assetBundle);
+
+#endif
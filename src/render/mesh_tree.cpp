@@ -6,10 +6,13 @@ DISABLE_WARNINGS_PUSH()
 #include <glm/gtx/transform.hpp>
 DISABLE_WARNINGS_POP()
 
+#include <render/bezier.h>
 #include <iostream>
 
 std::unordered_map<MeshTree*, std::shared_ptr<MeshTree>> MemoryManager::objs;
 
+static constexpr size_t NODES_PER_JOB = 64UL;
+
 MeshTree::MeshTree(std::string tag, const std::optional<HitBox>& maybeHitBox, GPUMesh* model,
                    glm::vec3 off, glm::vec4 rots, glm::vec4 rotp, glm::vec3 scl) {
     this->transform = {off, rots, rotp, scl};
@@ -25,8 +28,21 @@ void MeshTree::addChild(std::shared_ptr<MeshTree> child){
     this->children.push_back(child);
 }
 
-void MeshTree::transformExternal() {
-    // Transform objects managed by this node
+void MeshTree::transformExternal(utils::JobSystem& jobSystem) {
+    // Every node only writes to the objects it manages and reads its ancestors' transforms, so nodes are independent of each other
+    std::vector<std::shared_ptr<MeshTree>> nodes;
+    collectSubtree(nodes);
+    jobSystem.wait(jobSystem.parallelFor(nodes.size(), NODES_PER_JOB, [&nodes](size_t begin, size_t end) {
+        for (size_t nodeIdx = begin; nodeIdx < end; nodeIdx++) { nodes[nodeIdx]->transformManagedObjects(); }
+    }));
+}
+
+void MeshTree::collectSubtree(std::vector<std::shared_ptr<MeshTree>>& nodes) {
+    nodes.push_back(shared_from_this());
+    for (std::weak_ptr<MeshTree> child : children) { if (!child.expired()) { child.lock().get()->collectSubtree(nodes); } }
+}
+
+void MeshTree::transformManagedObjects() {
     glm::mat4 currTransform = modelMatrix(false);
     glm::vec4 homogeneous   = currTransform * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
     homogeneous             /= homogeneous.w;
@@ -39,9 +55,6 @@ void MeshTree::transformExternal() {
     }
     if (pl != nullptr) { pl->position = homogeneous; }
     if (particleEmitter != nullptr) { particleEmitter->m_position = homogeneous; }
-
-    // Transform objects managed by children
-    for (std::weak_ptr<MeshTree> child : children) { if (!child.expired()) { child.lock().get()->transformExternal(); } }
 }
 
 glm::mat4 MeshTree::modelMatrix(bool includeScale) const {
@@ -66,6 +79,7 @@ glm::mat4 MeshTree::modelMatrix(bool includeScale) const {
 
     // Rotate
     currTransform = glm::rotate(currTransform, glm::radians(transform.selfRotate.w), glm::vec3(transform.selfRotate.x, transform.selfRotate.y, transform.selfRotate.z));
+    currTransform = currTransform * glm::mat4_cast(transform.selfOrientation);
 
     // Scale
     if (includeScale) { currTransform = glm::scale(currTransform, transform.scale); }
@@ -139,7 +153,10 @@ bool MeshTree::tryTranslation(glm::vec3 translation, MeshTree* root) {
     return false;
 }
 
-void MeshTree::clean(LightManager& lmngr, ParticleEmitterManager& particleEmitterManager){
+void MeshTree::clean(LightManager& lmngr, ParticleEmitterManager& particleEmitterManager, BezierCurveManager& bezierCurveManager){
+    // Stop animations before their targets are freed
+    removeAnimations(bezierCurveManager);
+
     // Destroy all children
     for (size_t childIdx = 0; childIdx < children.size(); childIdx++) {
         if (!children[childIdx].expired()) {
@@ -153,3 +170,9 @@ void MeshTree::clean(LightManager& lmngr, ParticleEmitterManager& particleEmitte
     if (pl != nullptr)              { lmngr.removeByReference(pl); }
     if (particleEmitter != nullptr) { particleEmitterManager.removeByReference(particleEmitter); }
 }
+
+void MeshTree::removeAnimations(BezierCurveManager& bezierCurveManager) {
+    for (AnimationHandle animation : animations) { bezierCurveManager.remove(animation); }
+    animations.clear();
+    for (std::weak_ptr<MeshTree> child : children) { if (!child.expired()) { child.lock().get()->removeAnimations(bezierCurveManager); } }
+}
@@ -7,12 +7,15 @@ DISABLE_WARNINGS_PUSH()
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <glm/mat4x4.hpp>
+#include <glm/gtc/quaternion.hpp>
 DISABLE_WARNINGS_POP()
 #include <gameplay/enemy_camera.h>
+#include <render/animation_handle.h>
 #include <render/lighting.h>
 #include <render/mesh.h>
 #include <render/particle.h>
 #include <utils/hitbox.hpp>
+#include <utils/job_system.hpp>
 
 #include <filesystem>
 #include <vector>
@@ -20,11 +23,14 @@ DISABLE_WARNINGS_POP()
 #include <string>
 #include <unordered_map>
 
+class BezierCurveManager;
+
 struct MeshTransform {
     glm::vec3 translate;
     glm::vec4 selfRotate; // ROTATE AROUND AXIS
     glm::vec4 rotateParent;
     glm::vec3 scale;
+    glm::quat selfOrientation { 1.0f, 0.0f, 0.0f, 0.0f }; // Applied after selfRotate, driven by rotation tracks (see RotationTrack)
 };
 
 class MeshTree : public std::enable_shared_from_this<MeshTree> {
@@ -43,9 +49,10 @@ public:
     bool tryTranslation(glm::vec3 translation, MeshTree* root);
 
     // Mesh management
-    void clean(LightManager& lmngr, ParticleEmitterManager& particleEmitterManager);
+    void clean(LightManager& lmngr, ParticleEmitterManager& particleEmitterManager, BezierCurveManager& bezierCurveManager);
+    void removeAnimations(BezierCurveManager& bezierCurveManager); // Of this node and all of its descendants
     void addChild(std::shared_ptr<MeshTree> child);
-    void transformExternal();
+    void transformExternal(utils::JobSystem& jobSystem); // Moves the lights and particle emitters of the whole subtree
 
     glm::mat4 modelMatrix(bool includeScale = true) const;
 
@@ -58,6 +65,7 @@ public:
     MeshTransform transform;
     GPUMesh* mesh { nullptr };
     std::optional<HitBox> hitBox;
+    bool isStatic { false }; // Static geometry is culled on the GPU and rendered with indirect draws
 
     // Tree hierarchy management
     bool is_root = false;
@@ -68,11 +76,16 @@ public:
     AreaLight*  al                      { nullptr };
     PointLight* pl                      { nullptr };
     ParticleEmitter* particleEmitter    { nullptr };
+
+    // Animation tracks writing into this node's transform (see BezierCurveManager)
+    std::vector<AnimationHandle> animations;
   
 private:
     HitBox getTransformedHitBox();
     glm::vec3 getTransformedHitBoxMiddle();
     bool collide(MeshTree* other);
+    void collectSubtree(std::vector<std::shared_ptr<MeshTree>>& nodes);
+    void transformManagedObjects();
 
 };
 
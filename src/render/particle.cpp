@@ -2,70 +2,133 @@
 
 #include <framework/disable_all_warnings.h>
 DISABLE_WARNINGS_PUSH()
+#include <glm/gtc/matrix_access.hpp>
 #include <glm/gtc/type_ptr.hpp>
 DISABLE_WARNINGS_POP()
 
 #include <utils/constants.h>
+#include <utils/frustum.hpp>
 #include <utils/misc_utils.hpp>
+#include <utils/radix_sort.hpp>
+#include <utils/random.hpp>
+#include <utils/simd.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
 #include <iostream>
+#include <optional>
 
-ParticleEmitter::ParticleEmitter(glm::vec3 position, float velocityDeviation, float colorDeviation, float lifeDeviation, float sizeDeviation)
-    : m_position(position) {
-    for (size_t particleNum = 0UL; particleNum < utils::MAX_PARTICLES_PER_EMITTER; particleNum++) {
-        // Generate particle data with minor random variation
-        glm::vec3 velocity  = randomVelocity(velocityDeviation);
-        glm::vec4 color     = randomColor(colorDeviation);
-        float life          = randomLife(lifeDeviation);
-        float size          = randomSize(sizeDeviation);
-
-        // Create new particle and corresponding shader particle
-        particles.emplace_back(m_position, color, size, velocity, life);
-        particlesShader.emplace_back(m_position, color, size);
+// update() works on whole SIMD vectors of particles
+static constexpr size_t PARTICLE_SIMD_WIDTH = 4UL;
+static_assert(utils::MAX_PARTICLES_PER_EMITTER % PARTICLE_SIMD_WIDTH == 0UL, "Particle count must be a multiple of the SIMD width");
+static constexpr size_t EMITTERS_PER_JOB     = 4UL;
+
+// Sort modes of bitonic_sort.comp
+static constexpr GLuint BITONIC_SORT_BLOCKS     = 0U;
+static constexpr GLuint BITONIC_MERGE_GLOBAL    = 1U;
+static constexpr GLuint BITONIC_MERGE_BLOCKS    = 2U;
+
+void ParticlePool::resize(size_t numParticles) {
+    // New particles are dead and hidden until an emitter claims them
+    for (std::vector<float>* attribute : { &positionsX, &positionsY, &positionsZ, &velocitiesX, &velocitiesY, &velocitiesZ, &lives }) {
+        attribute->resize(numParticles, 0.0f);
     }
+    particlesShader.resize(numParticles, ParticleShader { glm::vec3(0.0f), glm::vec4(0.0f), 0.0f, glm::vec3(0.0f) });
 }
 
-glm::vec3 ParticleEmitter::randomVelocity(float velocityDeviation) const {
-    return glm::vec3(m_baseVelocity.x + utils::randomNumber(-velocityDeviation, velocityDeviation),
-                     m_baseVelocity.y + utils::randomNumber(-velocityDeviation, velocityDeviation),
-                     m_baseVelocity.z + utils::randomNumber(-velocityDeviation, velocityDeviation));
+ParticleEmitter::ParticleEmitter(glm::vec3 position, size_t offset, size_t count, ParticlePool& pool,
+                                 float velocityDeviation, float colorDeviation, float lifeDeviation, float sizeDeviation)
+    : m_position(position)
+    , m_offset(offset)
+    , m_count(count)
+    , m_budget(count) {
+    // Generate particle data with minor random variation
+    for (size_t particleIdx = m_offset; particleIdx < m_offset + m_count; particleIdx++) {
+        reviveParticle(pool, particleIdx, velocityDeviation, colorDeviation, lifeDeviation, sizeDeviation);
+    }
 }
 
-glm::vec4 ParticleEmitter::randomColor(float colorDeviation) const {
-    return glm::vec4(std::clamp(m_baseColor.r + utils::randomNumber(-colorDeviation, colorDeviation), 0.0f, 1.0f),
-                     std::clamp(m_baseColor.g + utils::randomNumber(-colorDeviation, colorDeviation), 0.0f, 1.0f),
-                     std::clamp(m_baseColor.b + utils::randomNumber(-colorDeviation, colorDeviation), 0.0f, 1.0f),
-                     std::clamp(m_baseColor.a + utils::randomNumber(-colorDeviation, colorDeviation), 0.0f, 1.0f));
+glm::vec4 ParticleEmitter::boundingSphere(float velocityDeviation, float lifeDeviation, float sizeDeviation) const {
+    // Particles move in a straight line for at most their maximum life; the base velocity moves the centre, the deviation grows the radius
+    const float maxSteps    = std::max(m_baseLife + lifeDeviation, 0.0f) / std::max(lifeDelta, 1e-4f);
+    const glm::vec3 center  = m_position + (0.5f * maxSteps) * m_baseVelocity;
+    const float radius      = maxSteps * (0.5f * glm::length(m_baseVelocity) + std::sqrt(3.0f) * velocityDeviation) + m_baseSize + sizeDeviation;
+    return glm::vec4(center, radius);
 }
 
-float ParticleEmitter::randomLife(float lifeDeviation) const { return m_baseLife + utils::randomNumber(-lifeDeviation, lifeDeviation); }
+void ParticleEmitter::reviveParticle(ParticlePool& pool, size_t idx, float velocityDeviation, float colorDeviation, float lifeDeviation, float sizeDeviation) {
+    // All deviations of a particle from a single batch of noise: velocity xyz, colour rgba, life, size (and one spare to fill the last vector)
+    std::array<float, 12> noise;
+    utils::threadRandomGenerator().fillUniform(noise, -1.0f, 1.0f);
 
-float ParticleEmitter::randomSize(float sizeDeviation) const { return m_baseSize + utils::randomNumber(-sizeDeviation, sizeDeviation); }
+    pool.positionsX[idx]            = m_position.x;
+    pool.positionsY[idx]            = m_position.y;
+    pool.positionsZ[idx]            = m_position.z;
+    pool.velocitiesX[idx]           = m_baseVelocity.x + velocityDeviation * noise[0];
+    pool.velocitiesY[idx]           = m_baseVelocity.y + velocityDeviation * noise[1];
+    pool.velocitiesZ[idx]           = m_baseVelocity.z + velocityDeviation * noise[2];
+    pool.lives[idx]                 = m_baseLife + lifeDeviation * noise[7];
 
+    ParticleShader& particleShader  = pool.particlesShader[idx];
+    particleShader.position         = m_position;
+    particleShader.color            = glm::clamp(m_baseColor + colorDeviation * glm::vec4(noise[3], noise[4], noise[5], noise[6]), 0.0f, 1.0f);
+    particleShader.size             = m_baseSize + sizeDeviation * noise[8];
+    particleShader.velocity         = glm::vec3(pool.velocitiesX[idx], pool.velocitiesY[idx], pool.velocitiesZ[idx]);
+}
 
-void ParticleEmitter::reviveParticle(size_t idx, float velocityDeviation, float colorDeviation, float lifeDeviation, float sizeDeviation) {
-    Particle& particle              = particles[idx];
-    ParticleShader& particleShader  = particlesShader[idx];
+void ParticleEmitter::reviveParticleAged(ParticlePool& pool, size_t idx, float velocityDeviation, float colorDeviation, float lifeDeviation, float sizeDeviation) {
+    // Advance a fresh particle by a random part of its life, as if it had been emitted while nobody was looking
+    reviveParticle(pool, idx, velocityDeviation, colorDeviation, lifeDeviation, sizeDeviation);
+    const float age                     = utils::randomNumber(0.0f, std::max(pool.lives[idx], 0.0f) / std::max(lifeDelta, 1e-4f));
+    pool.positionsX[idx]                += age * pool.velocitiesX[idx];
+    pool.positionsY[idx]                += age * pool.velocitiesY[idx];
+    pool.positionsZ[idx]                += age * pool.velocitiesZ[idx];
+    pool.lives[idx]                     -= age * lifeDelta;
+    pool.particlesShader[idx].position  = glm::vec3(pool.positionsX[idx], pool.positionsY[idx], pool.positionsZ[idx]);
+}
 
-    particle.position   = m_position;
-    particle.color      = randomColor(colorDeviation);
-    particle.velocity   = randomVelocity(velocityDeviation);
-    particle.life       = randomLife(lifeDeviation);
-    particle.size       = randomSize(sizeDeviation);
-    particleShader.position = particle.position;
-    particleShader.color    = particle.color;
-    particleShader.size     = particle.size;
+void ParticleEmitter::update(ParticlePool& pool, size_t budget, float velocityDeviation, float colorDeviation, float lifeDeviation, float sizeDeviation) {
+    const size_t numSimulated = std::min(budget, m_budget);
+    if (m_skippedSteps > 0U) {
+        // Catch up on the steps skipped while culled: survivors move in a straight line, the others are replaced at a random age
+        const float steps       = static_cast<float>(m_skippedSteps + 1U);
+        const float lifeSpan    = steps * lifeDelta;
+        for (size_t particleIdx = m_offset; particleIdx < m_offset + numSimulated; particleIdx++) {
+            if (pool.lives[particleIdx] > lifeSpan) {
+                pool.positionsX[particleIdx]                += steps * pool.velocitiesX[particleIdx];
+                pool.positionsY[particleIdx]                += steps * pool.velocitiesY[particleIdx];
+                pool.positionsZ[particleIdx]                += steps * pool.velocitiesZ[particleIdx];
+                pool.lives[particleIdx]                     -= lifeSpan;
+                pool.particlesShader[particleIdx].position  = glm::vec3(pool.positionsX[particleIdx], pool.positionsY[particleIdx], pool.positionsZ[particleIdx]);
+            } else { reviveParticleAged(pool, particleIdx, velocityDeviation, colorDeviation, lifeDeviation, sizeDeviation); }
+        }
+    } else { simulateRange(pool, m_offset, numSimulated, velocityDeviation, colorDeviation, lifeDeviation, sizeDeviation); }
+
+    // Particles entering the budget have been left alone for an unknown time
+    for (size_t particleIdx = m_offset + numSimulated; particleIdx < m_offset + budget; particleIdx++) {
+        reviveParticleAged(pool, particleIdx, velocityDeviation, colorDeviation, lifeDeviation, sizeDeviation);
+    }
+    m_budget        = budget;
+    m_skippedSteps  = 0U;
 }
 
-void ParticleEmitter::update(float velocityDeviation, float colorDeviation, float lifeDeviation, float sizeDeviation) {
-    for (size_t particleIdx = 0UL; particleIdx < particles.size(); particleIdx++) {
-        Particle& particle              = particles[particleIdx];
-        ParticleShader& particleShader  = particlesShader[particleIdx];
-
-        if ( particle.life > 0.0f ) {
-            particle.position   += particle.velocity;
-            particle.life       -= lifeDelta;
-            particleShader.position = particle.position;
-        } else { reviveParticle(particleIdx, velocityDeviation, colorDeviation, lifeDeviation, sizeDeviation); }
+void ParticleEmitter::simulateRange(ParticlePool& pool, size_t offset, size_t count, float velocityDeviation, float colorDeviation, float lifeDeviation, float sizeDeviation) {
+    const utils::Float4 zero        = utils::Float4::broadcast(0.0f);
+    const utils::Float4 lifeStep    = utils::Float4::broadcast(lifeDelta);
+    for (size_t firstIdx = offset; firstIdx < offset + count; firstIdx += PARTICLE_SIMD_WIDTH) {
+        // Integrate every lane, then revive the particles which were already dead (overwriting their integrated state)
+        const utils::Float4 life    = utils::Float4::load(&pool.lives[firstIdx]);
+        const int aliveLanes        = utils::Float4::greaterThan(life, zero).signMask();
+        (life - lifeStep).store(&pool.lives[firstIdx]);
+        (utils::Float4::load(&pool.positionsX[firstIdx]) + utils::Float4::load(&pool.velocitiesX[firstIdx])).store(&pool.positionsX[firstIdx]);
+        (utils::Float4::load(&pool.positionsY[firstIdx]) + utils::Float4::load(&pool.velocitiesY[firstIdx])).store(&pool.positionsY[firstIdx]);
+        (utils::Float4::load(&pool.positionsZ[firstIdx]) + utils::Float4::load(&pool.velocitiesZ[firstIdx])).store(&pool.positionsZ[firstIdx]);
+
+        for (size_t lane = 0UL; lane < PARTICLE_SIMD_WIDTH; lane++) {
+            const size_t particleIdx = firstIdx + lane;
+            if (aliveLanes & (1 << lane))   { pool.particlesShader[particleIdx].position = glm::vec3(pool.positionsX[particleIdx], pool.positionsY[particleIdx], pool.positionsZ[particleIdx]); }
+            else                            { reviveParticle(pool, particleIdx, velocityDeviation, colorDeviation, lifeDeviation, sizeDeviation); }
+        }
     }
 }
 
@@ -76,45 +139,188 @@ ParticleEmitterManager::ParticleEmitterManager(const RenderConfig& renderConfig)
         particleShaderBuilder.addStage(GL_VERTEX_SHADER, utils::SHADERS_DIR_PATH / "particles" / "particles.vert");
         particleShaderBuilder.addStage(GL_FRAGMENT_SHADER, utils::SHADERS_DIR_PATH / "particles" / "particles.frag");
         particleShader = particleShaderBuilder.build();
+
+        ShaderBuilder particleOITShaderBuilder;
+        particleOITShaderBuilder.addStage(GL_VERTEX_SHADER, utils::SHADERS_DIR_PATH / "particles" / "particles.vert");
+        particleOITShaderBuilder.addStage(GL_FRAGMENT_SHADER, utils::SHADERS_DIR_PATH / "particles" / "particles_oit.frag");
+        particleOITShader = particleOITShaderBuilder.build();
+
+        ShaderBuilder simulateBuilder;
+        simulateBuilder.addStage(GL_COMPUTE_SHADER, utils::SHADERS_DIR_PATH / "particles" / "simulate.comp");
+        simulateShader = simulateBuilder.build();
+
+        ShaderBuilder depthKeysBuilder;
+        depthKeysBuilder.addStage(GL_COMPUTE_SHADER, utils::SHADERS_DIR_PATH / "particles" / "depth_keys.comp");
+        depthKeysShader = depthKeysBuilder.build();
+
+        ShaderBuilder bitonicSortBuilder;
+        bitonicSortBuilder.addStage(GL_COMPUTE_SHADER, utils::SHADERS_DIR_PATH / "particles" / "bitonic_sort.comp");
+        bitonicSortShader = bitonicSortBuilder.build();
+
+        ShaderBuilder gpuParticleShaderBuilder;
+        gpuParticleShaderBuilder.addStage(GL_VERTEX_SHADER, utils::SHADERS_DIR_PATH / "particles" / "particles_gpu.vert");
+        gpuParticleShaderBuilder.addStage(GL_FRAGMENT_SHADER, utils::SHADERS_DIR_PATH / "particles" / "particles.frag");
+        gpuParticleShader = gpuParticleShaderBuilder.build();
+
+        ShaderBuilder gpuParticleOITShaderBuilder;
+        gpuParticleOITShaderBuilder.addStage(GL_VERTEX_SHADER, utils::SHADERS_DIR_PATH / "particles" / "particles_gpu.vert");
+        gpuParticleOITShaderBuilder.addStage(GL_FRAGMENT_SHADER, utils::SHADERS_DIR_PATH / "particles" / "particles_oit.frag");
+        gpuParticleOITShader = gpuParticleOITShaderBuilder.build();
     } catch (ShaderLoadingException e) { std::cerr << e.what() << std::endl; }
 }
 
+ParticleEmitterManager::~ParticleEmitterManager() {
+    glDeleteBuffers(1, &ssboParticles);
+    glDeleteBuffers(1, &ssboEmitters);
+    glDeleteBuffers(1, &ssboSortPairs);
+    glDeleteBuffers(1, &drawCommandBuffer);
+    glDeleteBuffers(1, &vertexVBO);
+    glDeleteBuffers(1, &particleVBO);
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteVertexArrays(1, &gpuVAO);
+}
+
+void ParticleEmitterManager::updateEmitters(const glm::mat4& viewProjectionMatrix, const glm::vec3& cameraPos, utils::JobSystem& jobSystem) {
+    const bool gpuSimulation = m_renderConfig.gpuParticles && pool.size() > 0UL;
+    if (gpuSimulation) {
+        if (!gpuStateResident) { uploadGpuState(); }
+        gpuEmitterParams.assign(pool.size() / utils::MAX_PARTICLES_PER_EMITTER, GPUParticleEmitter {});
+    } else if (gpuStateResident) { downloadGpuState(); } // Continue from the GPU state if the GPU simulation was just switched off
+
+    // Emitters outside of the view frustum are frozen; the others simulate a particle budget depending on their distance. Every
+    // emitter owns its range of the pool and its slot of the GPU parameters, so emitters are updated in parallel
+    const utils::Frustum frustum = utils::Frustum::fromViewProjection(viewProjectionMatrix);
+    jobSystem.wait(jobSystem.parallelFor(emitters.size(), EMITTERS_PER_JOB, [&](size_t begin, size_t end) {
+        for (size_t emitterIdx = begin; emitterIdx < end; emitterIdx++) {
+            ParticleEmitter& emitter    = *emitters[emitterIdx];
+            const glm::vec4 bounds      = emitter.boundingSphere(m_renderConfig.velocityDeviation, m_renderConfig.lifeDeviation, m_renderConfig.sizeDeviation);
+            emitter.m_visible           = !m_renderConfig.particleCulling || frustum.intersectsSphere(glm::vec3(bounds), bounds.w);
+            if (!emitter.m_visible) {
+                emitter.m_skippedSteps++;
+                continue;
+            }
+
+            const size_t budget = lodBudget(emitter, glm::distance(cameraPos, glm::vec3(bounds)));
+            if (gpuSimulation) {
+                // Emitter parameters can be edited at any time, so they are sent every step (a few bytes per pool slot)
+                gpuEmitterParams[emitter.m_offset / utils::MAX_PARTICLES_PER_EMITTER] = {
+                    emitter.m_position, emitter.lifeDelta, emitter.m_baseVelocity, emitter.m_baseLife, emitter.m_baseColor, emitter.m_baseSize,
+                    static_cast<uint32_t>(budget), static_cast<uint32_t>(std::min(budget, emitter.m_budget)), emitter.m_skippedSteps + 1U
+                };
+                emitter.m_budget        = budget;
+                emitter.m_skippedSteps  = 0U;
+            } else {
+                emitter.update(pool, budget, m_renderConfig.velocityDeviation, m_renderConfig.colorDeviation, m_renderConfig.lifeDeviation, m_renderConfig.sizeDeviation);
+            }
+        }
+    }));
+    if (gpuSimulation) { simulateGpu(); }
+}
+
+size_t ParticleEmitterManager::lodBudget(const ParticleEmitter& emitter, float distance) const {
+    // Full budget up close, shrinking linearly to the minimum fraction at the far distance; rounded up to whole SIMD vectors
+    const float lodRange    = std::max(m_renderConfig.particleLodFar - m_renderConfig.particleLodNear, 1e-4f);
+    const float farness     = std::clamp((distance - m_renderConfig.particleLodNear) / lodRange, 0.0f, 1.0f);
+    const float fraction    = glm::mix(1.0f, m_renderConfig.particleLodMinFraction, farness);
+    const size_t budget     = static_cast<size_t>(std::ceil(fraction * static_cast<float>(emitter.m_count)));
+    return std::min(((budget + PARTICLE_SIMD_WIDTH - 1UL) / PARTICLE_SIMD_WIDTH) * PARTICLE_SIMD_WIDTH, emitter.m_count);
+}
+
+GLsizei ParticleEmitterManager::numVisibleParticles() const {
+    size_t numParticles = 0UL;
+    for (const std::unique_ptr<ParticleEmitter>& emitter : emitters) {
+        if (emitter->m_visible) { numParticles += emitter->m_budget; }
+    }
+    return static_cast<GLsizei>(numParticles);
+}
+
+GLsizei ParticleEmitterManager::updateDrawCommands() const {
+    // One instanced quad draw per visible emitter, reading its budget straight from its range of the pool
+    drawCommands.clear();
+    for (const std::unique_ptr<ParticleEmitter>& emitter : emitters) {
+        if (!emitter->m_visible) { continue; }
+        drawCommands.push_back({ 4U, static_cast<GLuint>(emitter->m_budget), 0U, static_cast<GLuint>(emitter->m_offset) });
+    }
+    glNamedBufferData(drawCommandBuffer, drawCommands.size() * sizeof(DrawArraysIndirectCommand), drawCommands.data(), GL_STREAM_DRAW);
+    return static_cast<GLsizei>(drawCommands.size());
+}
+
 ParticleEmitter* ParticleEmitterManager::addEmitter(glm::vec3 position) {
-    ParticleEmitter* newEmitter = new ParticleEmitter(position,
-                                                      m_renderConfig.velocityDeviation,
-                                                      m_renderConfig.colorDeviation,
-                                                      m_renderConfig.lifeDeviation,
-                                                      m_renderConfig.sizeDeviation);
-    emitters.push_back(newEmitter);
+    std::optional<size_t> offset = poolAllocator.allocate(utils::MAX_PARTICLES_PER_EMITTER, utils::MAX_PARTICLES_PER_EMITTER);
+    if (!offset.has_value()) {
+        growPool();
+        offset = poolAllocator.allocate(utils::MAX_PARTICLES_PER_EMITTER, utils::MAX_PARTICLES_PER_EMITTER);
+    }
+
+    emitters.push_back(std::make_unique<ParticleEmitter>(position, offset.value(), utils::MAX_PARTICLES_PER_EMITTER, pool,
+                                                         m_renderConfig.velocityDeviation,
+                                                         m_renderConfig.colorDeviation,
+                                                         m_renderConfig.lifeDeviation,
+                                                         m_renderConfig.sizeDeviation));
+    ParticleEmitter* newEmitter = emitters.back().get();
+    newEmitter->m_listIdx       = emitters.size() - 1UL;
+    if (gpuStateResident) { uploadGpuRange(newEmitter->m_offset, newEmitter->m_count); }
     return newEmitter; 
 }
 
-void ParticleEmitterManager::removeEmitter(size_t idx) {
-    free(emitters[idx]); 
-    emitters.erase(emitters.begin() + idx);
-}
+void ParticleEmitterManager::removeEmitter(size_t idx) { releaseEmitter(idx); }
 
 void ParticleEmitterManager::removeByReference(ParticleEmitter* emitter) {
     if (emitter == nullptr) { return; }
+    if (emitter->m_listIdx < emitters.size() && emitters[emitter->m_listIdx].get() == emitter) { releaseEmitter(emitter->m_listIdx); }
+}
 
-    for (size_t emitterIdx = 0UL; emitterIdx < emitters.size(); emitterIdx++) {
-        ParticleEmitter* currentEmitter = emitters[emitterIdx];
-        if (currentEmitter == emitter) { 
-            free(currentEmitter);
-            emitters.erase(emitters.begin() + emitterIdx);
-            return;
-        }
-    }
+void ParticleEmitterManager::growPool() {
+    // The GPU copy of the state is rebuilt from the grown pool on the next simulation step
+    if (gpuStateResident) { downloadGpuState(); }
+
+    const size_t newCapacity = std::max(2UL * pool.size(), utils::MAX_PARTICLES_PER_EMITTER);
+    pool.resize(newCapacity);
+    poolAllocator.grow(newCapacity);
+    glNamedBufferData(particleVBO, newCapacity * sizeof(ParticleShader), nullptr, GL_STREAM_DRAW);
+}
+
+void ParticleEmitterManager::releaseEmitter(size_t listIdx) {
+    // Give the emitter's range back to the pool; ranges without an emitter are never drawn
+    const ParticleEmitter& emitter = *emitters[listIdx];
+    poolAllocator.free(emitter.m_offset, emitter.m_count);
+
+    // Swap-and-pop from the emitter list
+    std::swap(emitters[listIdx], emitters.back());
+    emitters[listIdx]->m_listIdx = listIdx;
+    emitters.pop_back();
 }
 
 void ParticleEmitterManager::render(GLuint renderBuffer, const glm::mat4& viewProjectionMatrix) const {
+    // Weighted blended OIT does not depend on draw order, so particles need no depth sorting in that mode
+    const bool orderIndependent = m_renderConfig.particleOIT;
     glBindFramebuffer(GL_FRAMEBUFFER, renderBuffer);
-    particleShader.bind();
+    if (m_renderConfig.gpuParticles && gpuStateResident) {
+        // Draw straight from the particle SSBO, in the order of the sorted pairs if needed
+        if (!orderIndependent) { sortGpu(viewProjectionMatrix); }
+        (orderIndependent ? gpuParticleOITShader : gpuParticleShader).bind();
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, ssboParticles);
+        glUniform1i(4, !orderIndependent);
+        glBindVertexArray(gpuVAO);
+    } else {
+        (orderIndependent ? particleOITShader : particleShader).bind();
+        updateAndBindAttributeBuffers(viewProjectionMatrix);
+    }
     glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-    updateAndBindAttributeBuffers(viewProjectionMatrix);
+    if (orderIndependent) {
+        glBlendFunci(0, GL_ONE, GL_ONE);                    // Accumulation
+        glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);   // Revealage
+        glDepthMask(GL_FALSE);
+    } else { glBlendFunc(GL_SRC_ALPHA, GL_ONE); }
     glUniformMatrix4fv(0, 1, GL_FALSE, glm::value_ptr(viewProjectionMatrix));
-    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(emitters.size() * utils::MAX_PARTICLES_PER_EMITTER));
+    glUniform1f(5, m_interpolation);
+    if (orderIndependent) {
+        const GLsizei numDrawCommands = updateDrawCommands();
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommandBuffer);
+        glMultiDrawArraysIndirect(GL_TRIANGLE_STRIP, nullptr, numDrawCommands, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    } else { glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, numVisibleParticles()); }
+    glDepthMask(GL_TRUE);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glDisable(GL_BLEND);
 }
@@ -139,6 +345,8 @@ void ParticleEmitterManager::genAttributeBuffers() {
     glVertexArrayAttribFormat(VAO, 2, 4, GL_FLOAT, GL_FALSE, offsetof(ParticleShader, color));
     glEnableVertexArrayAttrib(VAO, 3);
     glVertexArrayAttribFormat(VAO, 3, 1, GL_FLOAT, GL_FALSE, offsetof(ParticleShader, size));
+    glEnableVertexArrayAttrib(VAO, 4);
+    glVertexArrayAttribFormat(VAO, 4, 3, GL_FLOAT, GL_FALSE, offsetof(ParticleShader, velocity));
 
     // Tell OpenGL which VBO to get data at each location from
     glVertexArrayAttribBinding(VAO, 0, 0);
@@ -153,28 +361,156 @@ void ParticleEmitterManager::genAttributeBuffers() {
     glVertexArrayBindingDivisor(VAO, 2, 1); 
     glVertexArrayBindingDivisor(VAO, 3, 1); 
     glVertexArrayBindingDivisor(VAO, 4, 1);
+
+    // The GPU path only needs the quad vertices; particle data is fetched from SSBOs by instance ID
+    glCreateVertexArrays(1, &gpuVAO);
+    glVertexArrayVertexBuffer(gpuVAO, 0, vertexVBO, 0, 3 * sizeof(GLfloat));
+    glEnableVertexArrayAttrib(gpuVAO, 0);
+    glVertexArrayAttribFormat(gpuVAO, 0, 3, GL_FLOAT, GL_FALSE, 0);
+    glVertexArrayAttribBinding(gpuVAO, 0, 0);
+
+    // GPU simulation buffers
+    glCreateBuffers(1, &ssboParticles);
+    glCreateBuffers(1, &ssboEmitters);
+    glCreateBuffers(1, &ssboSortPairs);
+
+    // Indirect draw commands of the unsorted (order-independent) draws
+    glCreateBuffers(1, &drawCommandBuffer);
 }
 
-std::vector<ParticleShader> ParticleEmitterManager::genSortedParticles(const glm::mat4& viewProjectionMatrix) const {
-    // Copy over particles from all emitters
-    std::vector<ParticleShader> sortedParticles;
-    for (const ParticleEmitter* emitter : emitters) {
-        std::copy(emitter->particlesShader.begin(), emitter->particlesShader.end(), std::back_inserter(sortedParticles));
+const std::vector<ParticleShader>& ParticleEmitterManager::genSortedParticles(const glm::mat4& viewProjectionMatrix) const {
+    // Clip-space depth of the budget of every visible emitter in one linear pass, keyed so that an ascending sort puts the furthest
+    // particle first
+    const glm::vec4 depthRow    = glm::row(viewProjectionMatrix, 2);
+    const size_t numParticles   = static_cast<size_t>(numVisibleParticles());
+    sortKeys.resize(numParticles);
+    sortIndices.resize(numParticles);
+    sortScratchKeys.resize(numParticles);
+    sortScratchIndices.resize(numParticles);
+    size_t sortIdx = 0UL;
+    for (const std::unique_ptr<ParticleEmitter>& emitter : emitters) {
+        if (!emitter->m_visible) { continue; }
+        for (size_t particleIdx = emitter->m_offset; particleIdx < emitter->m_offset + emitter->m_budget; particleIdx++, sortIdx++) {
+            const float depth       = depthRow.x * pool.positionsX[particleIdx] + depthRow.y * pool.positionsY[particleIdx] +
+                                      depthRow.z * pool.positionsZ[particleIdx] + depthRow.w;
+            sortKeys[sortIdx]       = ~utils::sortableFloatKey(depth);
+            sortIndices[sortIdx]    = static_cast<uint32_t>(particleIdx);
+        }
     }
+    utils::radixSortPairs(sortKeys, sortIndices, sortScratchKeys, sortScratchIndices);
 
-    // Sort by reverse camera-view depth (furthest first) and return
-    std::sort(sortedParticles.begin(), sortedParticles.end(),
-              [viewProjectionMatrix](ParticleShader left, ParticleShader right) { 
-                            left.position   = glm::vec3(viewProjectionMatrix * glm::vec4(left.position, 1.0f));
-                            right.position  = glm::vec3(viewProjectionMatrix * glm::vec4(right.position, 1.0f));
-                            return left.position.z > right.position.z;
-                        });
+    // Gather render attributes in sorted order
+    sortedParticles.resize(numParticles);
+    for (sortIdx = 0UL; sortIdx < numParticles; sortIdx++) { sortedParticles[sortIdx] = pool.particlesShader[sortIndices[sortIdx]]; }
     return sortedParticles;
 }
 
 void ParticleEmitterManager::updateAndBindAttributeBuffers(const glm::mat4& viewProjectionMatrix) const {
-    // Copy sorted particle data and bind VAO
-    std::vector<ParticleShader> sortedParticles = genSortedParticles(viewProjectionMatrix);
-    glNamedBufferData(particleVBO, sortedParticles.size() * sizeof(ParticleShader), sortedParticles.data(), GL_STREAM_DRAW);
+    // Draw order does not matter with OIT, so the pool is uploaded in place and drawn per emitter range; otherwise only the visible
+    // particles are uploaded, sorted
+    const std::vector<ParticleShader>& particles = m_renderConfig.particleOIT ? pool.particlesShader : genSortedParticles(viewProjectionMatrix);
+    glInvalidateBufferData(particleVBO);
+    glNamedBufferSubData(particleVBO, 0, particles.size() * sizeof(ParticleShader), particles.data());
     glBindVertexArray(VAO);
 }
+
+void ParticleEmitterManager::uploadGpuState() {
+    glNamedBufferData(ssboParticles, pool.size() * sizeof(GPUParticle), nullptr, GL_DYNAMIC_COPY);
+    uploadGpuRange(0UL, pool.size());
+    gpuStateResident = true;
+}
+
+void ParticleEmitterManager::uploadGpuRange(size_t offset, size_t count) {
+    std::vector<GPUParticle> particles;
+    particles.reserve(count);
+    for (size_t particleIdx = offset; particleIdx < offset + count; particleIdx++) {
+        const ParticleShader& renderAttributes = pool.particlesShader[particleIdx];
+        particles.push_back({ glm::vec3(pool.positionsX[particleIdx], pool.positionsY[particleIdx], pool.positionsZ[particleIdx]),
+                              pool.lives[particleIdx],
+                              glm::vec3(pool.velocitiesX[particleIdx], pool.velocitiesY[particleIdx], pool.velocitiesZ[particleIdx]),
+                              renderAttributes.size,
+                              renderAttributes.color });
+    }
+    glNamedBufferSubData(ssboParticles, offset * sizeof(GPUParticle), particles.size() * sizeof(GPUParticle), particles.data());
+}
+
+void ParticleEmitterManager::downloadGpuState() {
+    std::vector<GPUParticle> particles(pool.size());
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glGetNamedBufferSubData(ssboParticles, 0, particles.size() * sizeof(GPUParticle), particles.data());
+    for (size_t particleIdx = 0UL; particleIdx < particles.size(); particleIdx++) {
+        const GPUParticle& particle                     = particles[particleIdx];
+        pool.positionsX[particleIdx]                    = particle.position.x;
+        pool.positionsY[particleIdx]                    = particle.position.y;
+        pool.positionsZ[particleIdx]                    = particle.position.z;
+        pool.velocitiesX[particleIdx]                   = particle.velocity.x;
+        pool.velocitiesY[particleIdx]                   = particle.velocity.y;
+        pool.velocitiesZ[particleIdx]                   = particle.velocity.z;
+        pool.lives[particleIdx]                         = particle.life;
+        pool.particlesShader[particleIdx].position      = particle.position;
+        pool.particlesShader[particleIdx].color         = particle.color;
+        pool.particlesShader[particleIdx].size          = particle.size;
+        pool.particlesShader[particleIdx].velocity      = particle.velocity;
+    }
+    gpuStateResident = false;
+}
+
+void ParticleEmitterManager::simulateGpu() {
+    glNamedBufferData(ssboEmitters, gpuEmitterParams.size() * sizeof(GPUParticleEmitter), gpuEmitterParams.data(), GL_STREAM_DRAW);
+
+    // One thread per particle of the pool
+    const GLuint numParticles = static_cast<GLuint>(pool.size());
+    simulateShader.bind();
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, ssboParticles);   // Bind to binding=7
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, ssboEmitters);    // Bind to binding=8
+    glUniform1ui(0, numParticles);
+    glUniform1ui(1, static_cast<GLuint>(utils::MAX_PARTICLES_PER_EMITTER));
+    glUniform1ui(2, gpuFrameIdx++);
+    glUniform4f(3, m_renderConfig.velocityDeviation, m_renderConfig.colorDeviation, m_renderConfig.lifeDeviation, m_renderConfig.sizeDeviation);
+    glDispatchCompute(numParticles / GPU_WORKGROUP_SIZE, 1U, 1U);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void ParticleEmitterManager::sortGpu(const glm::mat4& viewProjectionMatrix) const {
+    // Bitonic sorting needs a power of two number of pairs; the padding sorts behind every particle and is never drawn
+    const GLuint numParticles   = static_cast<GLuint>(pool.size());
+    const GLuint numSortPairs   = std::bit_ceil(numParticles);
+    const GLuint numBlocks      = numSortPairs / GPU_SORT_BLOCK_SIZE;
+    if (numParticles == 0U) { return; }
+    const GLsizeiptr sortPairsSize = static_cast<GLsizeiptr>(numSortPairs * 2U * sizeof(GLuint));
+    if (sortPairsSize > sortPairsCapacity) {
+        glNamedBufferData(ssboSortPairs, sortPairsSize, nullptr, GL_DYNAMIC_COPY);
+        sortPairsCapacity = sortPairsSize;
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, ssboParticles);   // Bind to binding=7
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, ssboEmitters);    // Bind to binding=8
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, ssboSortPairs);   // Bind to binding=9
+
+    // Clip-space depth keys, ordered so that an ascending sort puts the furthest particle first. Particles outside of the budget of
+    // a visible emitter sort behind the visible ones, which are the only ones drawn
+    depthKeysShader.bind();
+    glUniform4fv(0, 1, glm::value_ptr(glm::row(viewProjectionMatrix, 2)));
+    glUniform1ui(1, numParticles);
+    glUniform1ui(2, static_cast<GLuint>(utils::MAX_PARTICLES_PER_EMITTER));
+    glDispatchCompute(numSortPairs / GPU_WORKGROUP_SIZE, 1U, 1U);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // Sort every block in shared memory, then merge into ever larger sequences. Merge steps comparing pairs further apart than a
+    // block go through global memory one dispatch at a time; the remaining steps of a sequence size run in shared memory again
+    bitonicSortShader.bind();
+    glUniform1ui(0, BITONIC_SORT_BLOCKS);
+    glDispatchCompute(numBlocks, 1U, 1U);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    for (GLuint sequenceSize = 2U * GPU_SORT_BLOCK_SIZE; sequenceSize <= numSortPairs; sequenceSize <<= 1) {
+        glUniform1ui(0, BITONIC_MERGE_GLOBAL);
+        glUniform1ui(1, sequenceSize);
+        for (GLuint compareDistance = sequenceSize / 2U; compareDistance >= GPU_SORT_BLOCK_SIZE; compareDistance >>= 1) {
+            glUniform1ui(2, compareDistance);
+            glDispatchCompute(numBlocks, 1U, 1U);
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        }
+        glUniform1ui(0, BITONIC_MERGE_BLOCKS);
+        glDispatchCompute(numBlocks, 1U, 1U);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+}
@@ -10,34 +10,88 @@ DISABLE_WARNINGS_POP()
 #include <framework/shader.h>
 
 #include <render/config.h>
+#include <utils/constants.h>
+#include <utils/free_list.hpp>
+#include <utils/job_system.hpp>
 #include <array>
+#include <memory>
 #include <stdint.h>
 #include <vector>
 
 // TODO: Expand with ability to use texture to define color
-struct Particle {
-    // Shader data
+// Render attributes of a particle, as read by the particle VBO
+struct ParticleShader {
     glm::vec3 position;
     glm::vec4 color;
     float size;
+    glm::vec3 velocity; // Displacement per simulation step, used to draw particles in between steps
 
-    glm::vec3 velocity;
-    float life;
+    constexpr auto operator<=>(const ParticleShader& other) const { position.z <=> other.position.z; }
 };
 
-struct ParticleShader {
+// Complete particle state of the GPU simulation, as read by the particle SSBO (std430)
+struct GPUParticle {
     glm::vec3 position;
-    glm::vec4 color;
+    float life;
+    glm::vec3 velocity;
     float size;
+    glm::vec4 color;
+};
+static_assert(sizeof(GPUParticle) == 48UL, "GPUParticle must match the std430 layout of the particle shaders");
 
-    constexpr auto operator<=>(const ParticleShader& other) const { position.z <=> other.position.z; }
+// Per-emitter parameters of the GPU simulation, one per pool slot, as read by the emitter SSBO (std430)
+struct GPUParticleEmitter {
+    glm::vec3 position;
+    float lifeDelta;
+    glm::vec3 baseVelocity;
+    float baseLife;
+    glm::vec4 baseColor;
+    float baseSize;
+    uint32_t budget;            // Particles simulated and drawn this step; zero for culled emitters and unused slots
+    uint32_t firstNewParticle;  // Particles from here up to the budget just entered the budget and start at a random age
+    uint32_t steps;             // Steps to advance, more than one when catching up after being culled
+};
+static_assert(sizeof(GPUParticleEmitter) == 64UL, "GPUParticleEmitter must match the std430 layout of simulate.comp");
+
+// Simulation state and render attributes of every particle, as structure-of-arrays so the update processes several particles per
+// instruction. Emitters own ranges of it; colour and size only change on revival and live in the render attributes alone
+struct ParticlePool {
+    std::vector<float> positionsX, positionsY, positionsZ;
+    std::vector<float> velocitiesX, velocitiesY, velocitiesZ;
+    std::vector<float> lives;
+
+    // Render attributes of all particles, contiguous for upload
+    std::vector<ParticleShader> particlesShader;
+
+    size_t size() const { return lives.size(); }
+    void resize(size_t numParticles);
+};
+
+// Argument layout of glMultiDrawArraysIndirect
+struct DrawArraysIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint first;
+    GLuint baseInstance;
 };
 
 class ParticleEmitter {
 public:
-    ParticleEmitter(glm::vec3 position, float velocityDeviation, float colorDeviation, float lifeDeviation, float sizeDeviation);
+    ParticleEmitter(glm::vec3 position, size_t offset, size_t count, ParticlePool& pool,
+                    float velocityDeviation, float colorDeviation, float lifeDeviation, float sizeDeviation);
+
+    // Simulates the first budget particles of the range. Steps skipped while culled are caught up on in a single approximate pass,
+    // and particles which were outside of the budget the previous step are revived at a random age
+    void update(ParticlePool& pool, size_t budget, float velocityDeviation, float colorDeviation, float lifeDeviation, float sizeDeviation);
+
+    // Sphere enclosing every particle this emitter can currently produce (XYZ is the centre, W the radius)
+    glm::vec4 boundingSphere(float velocityDeviation, float lifeDeviation, float sizeDeviation) const;
 
-    void update(float velocityDeviation, float colorDeviation, float lifeDeviation, float sizeDeviation);
+    // Range of the particle pool owned by this emitter
+    size_t offset() const   { return m_offset; }
+    size_t count() const    { return m_count; }
+    size_t budget() const   { return m_budget; }
+    bool visible() const    { return m_visible; }
 
     // Initial values used for initialisation and resurrection of particles
     glm::vec3 m_baseVelocity    { 0.001f, 0.001f, 0.001f };
@@ -48,27 +102,32 @@ public:
     float lifeDelta     { 1.0f };
     glm::vec3 m_position;
 
-    std::vector<Particle> particles;
-    std::vector<ParticleShader> particlesShader;
-
 private:
-    glm::vec3 randomVelocity(float velocityDeviation) const;
-    glm::vec4 randomColor(float colorDeviation) const;
-    float randomLife(float lifeDeviation) const;
-    float randomSize(float sizeDeviation) const;
-    void reviveParticle(size_t idx, float velocityDeviation, float colorDeviation, float lifeDeviation, float sizeDeviation);
+    friend class ParticleEmitterManager;
+
+    size_t m_offset;
+    size_t m_count;
+    size_t m_listIdx        { 0UL };    // Position in the manager's emitter list, for constant time removal
+    size_t m_budget;                    // Particles simulated during the last step in which the emitter was visible
+    uint32_t m_skippedSteps { 0U };     // Steps skipped while culled
+    bool m_visible          { false };  // Not drawn until its first update
+
+    void reviveParticle(ParticlePool& pool, size_t idx, float velocityDeviation, float colorDeviation, float lifeDeviation, float sizeDeviation);
+    void reviveParticleAged(ParticlePool& pool, size_t idx, float velocityDeviation, float colorDeviation, float lifeDeviation, float sizeDeviation);
+    void simulateRange(ParticlePool& pool, size_t offset, size_t count, float velocityDeviation, float colorDeviation, float lifeDeviation, float sizeDeviation);
 };
 
 class ParticleEmitterManager {
 public:
     ParticleEmitterManager(const RenderConfig& renderConfig);
+    ~ParticleEmitterManager();
 
     void render(GLuint renderBuffer, const glm::mat4& viewProjectionMatrix) const;
-    void updateEmitters() { for (ParticleEmitter* emitter : emitters) { emitter->update(
-        m_renderConfig.velocityDeviation, m_renderConfig.colorDeviation, m_renderConfig.lifeDeviation, m_renderConfig.sizeDeviation
-    ); } }
+    void updateEmitters(const glm::mat4& viewProjectionMatrix, const glm::vec3& cameraPos, utils::JobSystem& jobSystem); // One simulation step
+
+    // Fraction of a simulation step to interpolate rendered particles by, from their previous position (0) to their latest one (1)
+    void setInterpolation(float interpolation) { m_interpolation = interpolation; }
 
-    
     ParticleEmitter& emitterAt(size_t idx)  { return *emitters[idx]; }
     size_t numEmitters()                    { return emitters.size(); }
     ParticleEmitter* addEmitter(glm::vec3 position);
@@ -84,19 +143,57 @@ private:
          0.5f, -0.5f,  0.0f
     };
 
-    std::vector<ParticleEmitter*> emitters;
-
-    // OpenGL rendering
+    // All particles live in a single pool, handed out to emitters in ranges of MAX_PARTICLES_PER_EMITTER. The pool doubles when
+    // full; ranges of removed emitters are reused. Only the budget of visible emitters is ever drawn
+    ParticlePool pool;
+    utils::FreeListAllocator poolAllocator;
+    std::vector<std::unique_ptr<ParticleEmitter>> emitters;
+
+    // GPU simulation (RenderConfig::gpuParticles). Particle state lives in an SSBO mirroring the pool while enabled; the CPU pool is
+    // only brought up to date when the pool grows, or when switching back to the CPU simulation
+    static constexpr GLuint GPU_WORKGROUP_SIZE  = 256U;
+    static constexpr GLuint GPU_SORT_BLOCK_SIZE = 2U * GPU_WORKGROUP_SIZE; // Must match BLOCK_SIZE in bitonic_sort.comp
+    static_assert(utils::MAX_PARTICLES_PER_EMITTER % GPU_SORT_BLOCK_SIZE == 0UL, "Particle count must be a multiple of the sort block size");
+    GLuint gpuVAO               { INVALID };
+    GLuint ssboParticles        { INVALID };
+    GLuint ssboEmitters         { INVALID };
+    GLuint ssboSortPairs        { INVALID };
+    mutable GLsizeiptr sortPairsCapacity { 0 };
+    bool gpuStateResident       { false };
+    uint32_t gpuFrameIdx        { 0U };
+    std::vector<GPUParticleEmitter> gpuEmitterParams;
+    Shader simulateShader, depthKeysShader, bitonicSortShader, gpuParticleShader, gpuParticleOITShader;
+
+    // OpenGL rendering. The particle VBO holds as many particles as the pool and is only reallocated when the pool grows
     GLuint VAO          { INVALID };
     GLuint vertexVBO    { INVALID };
     GLuint particleVBO  { INVALID };
+    GLuint drawCommandBuffer { INVALID };
     Shader particleShader;
+    Shader particleOITShader;
+
+    // Depth sorting buffers, reused every frame
+    mutable std::vector<uint32_t> sortKeys, sortIndices, sortScratchKeys, sortScratchIndices;
+    mutable std::vector<ParticleShader> sortedParticles;
+    mutable std::vector<DrawArraysIndirectCommand> drawCommands;
 
     const RenderConfig& m_renderConfig;
+    float m_interpolation { 1.0f };
 
     void genAttributeBuffers();
-    std::vector<ParticleShader> genSortedParticles(const glm::mat4& viewProjectionMatrix) const;
+    void growPool();
+    void releaseEmitter(size_t listIdx);
+    size_t lodBudget(const ParticleEmitter& emitter, float distance) const;
+    GLsizei numVisibleParticles() const;
+    GLsizei updateDrawCommands() const;
+    const std::vector<ParticleShader>& genSortedParticles(const glm::mat4& viewProjectionMatrix) const;
     void updateAndBindAttributeBuffers(const glm::mat4& viewProjectionMatrix) const;
+
+    void uploadGpuState();
+    void uploadGpuRange(size_t offset, size_t count);
+    void downloadGpuState();
+    void simulateGpu();
+    void sortGpu(const glm::mat4& viewProjectionMatrix) const;
 };
 
 #endif
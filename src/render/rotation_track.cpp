@@ -0,0 +1,72 @@
+#include "rotation_track.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/gtx/quaternion.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+
+// Same orientation as quaternion, negated if needed to lie in the hemisphere of reference
+static glm::quat alignHemisphere(const glm::quat& quaternion, const glm::quat& reference) {
+    return glm::dot(quaternion, reference) < 0.0f ? -quaternion : quaternion;
+}
+
+RotationTrack::RotationTrack(std::vector<float> keyTimes, std::vector<glm::quat> keys, bool loop, RotationInterpolation interpolation)
+    : keyTimes(std::move(keyTimes))
+    , keys(std::move(keys))
+    , loop(loop)
+    , interpolation(interpolation) {
+    if (this->keys.empty() || this->keys.size() != this->keyTimes.size()) { throw std::invalid_argument("Rotation tracks need one time per key and at least one key"); }
+    if (!std::is_sorted(this->keyTimes.begin(), this->keyTimes.end()))   { throw std::invalid_argument("Rotation track key times must be ascending"); }
+
+    this->keys.front() = glm::normalize(this->keys.front());
+    for (size_t keyIdx = 1UL; keyIdx < this->keys.size(); keyIdx++) {
+        this->keys[keyIdx] = alignHemisphere(glm::normalize(this->keys[keyIdx]), this->keys[keyIdx - 1UL]);
+    }
+
+    // Squad control points. Looping tracks take the neighbours across the seam (the last key duplicates the first), the end points
+    // of other tracks use themselves as their missing neighbour
+    const size_t numKeys    = this->keys.size();
+    const bool wrap         = this->loop && numKeys > 2UL;
+    intermediates.resize(numKeys);
+    for (size_t keyIdx = 0UL; keyIdx < numKeys; keyIdx++) {
+        const glm::quat& key    = this->keys[keyIdx];
+        const glm::quat& prev   = keyIdx > 0UL              ? this->keys[keyIdx - 1UL] : (wrap ? this->keys[numKeys - 2UL] : key);
+        const glm::quat& next   = keyIdx + 1UL < numKeys    ? this->keys[keyIdx + 1UL] : (wrap ? this->keys[1UL] : key);
+        intermediates[keyIdx]   = glm::intermediate(alignHemisphere(prev, key), key, alignHemisphere(next, key));
+    }
+}
+
+glm::quat RotationTrack::rotationAtTime(float t) const {
+    const auto [keyIdx, h] = locateKey(keyTimes, loop, t);
+    if (keys.size() == 1UL) { return keys.front(); }
+    return interpolate(interpolation, keys[keyIdx], keys[keyIdx + 1UL], intermediates[keyIdx], intermediates[keyIdx + 1UL], h);
+}
+
+std::pair<size_t, float> RotationTrack::locateKey(std::span<const float> keyTimes, bool loop, float t) {
+    if (keyTimes.size() < 2UL) { return { 0UL, 0.0f }; }
+
+    const float period = keyTimes.back() - keyTimes.front();
+    if (loop && period > 0.0f) { t -= period * std::floor((t - keyTimes.front()) / period); }
+
+    // Searching the inner keys only keeps the segment in range, times outside the track are clamped through h
+    const auto nextKeyIter  = std::upper_bound(keyTimes.begin() + 1, keyTimes.end() - 1, t);
+    const size_t keyIdx     = static_cast<size_t>(std::distance(keyTimes.begin(), nextKeyIter)) - 1UL;
+    const float duration    = keyTimes[keyIdx + 1UL] - keyTimes[keyIdx];
+    const float h           = duration > 0.0f ? std::clamp((t - keyTimes[keyIdx]) / duration, 0.0f, 1.0f) : 1.0f;
+    return { keyIdx, h };
+}
+
+glm::quat RotationTrack::interpolate(RotationInterpolation interpolation, const glm::quat& key, const glm::quat& nextKey,
+                                     const glm::quat& intermediate, const glm::quat& nextIntermediate, float h) {
+    switch (interpolation) {
+        case RotationInterpolation::Nlerp: { return glm::normalize(key * (1.0f - h) + nextKey * h); }
+        case RotationInterpolation::Slerp: { return glm::slerp(key, nextKey, h); }
+        case RotationInterpolation::Squad: { return glm::normalize(glm::squad(key, nextKey, intermediate, nextIntermediate, h)); }
+    }
+    return key;
+}
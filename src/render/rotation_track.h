@@ -0,0 +1,37 @@
+#ifndef _ROTATION_TRACK_H_
+#define _ROTATION_TRACK_H_
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/gtc/quaternion.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <span>
+#include <utility>
+#include <vector>
+
+enum class RotationInterpolation { Nlerp, Slerp, Squad };
+
+// Keyframed orientation, evaluated directly as a quaternion. Keys are flipped into the hemisphere of their predecessor so every
+// segment takes the short way round, hence a full turn needs keys less than 180 degrees apart. Looping tracks repeat from the
+// first to the last key time, so the last key should match the first orientation
+class RotationTrack {
+public:
+    RotationTrack(std::vector<float> keyTimes, std::vector<glm::quat> keys, bool loop,
+                  RotationInterpolation interpolation = RotationInterpolation::Squad);
+
+    glm::quat rotationAtTime(float t) const;
+
+    // Index of the key starting the segment containing t and the normalised time within that segment
+    static std::pair<size_t, float> locateKey(std::span<const float> keyTimes, bool loop, float t);
+    static glm::quat interpolate(RotationInterpolation interpolation, const glm::quat& key, const glm::quat& nextKey,
+                                 const glm::quat& intermediate, const glm::quat& nextIntermediate, float h);
+
+    std::vector<float> keyTimes;            // Ascending
+    std::vector<glm::quat> keys;
+    std::vector<glm::quat> intermediates;   // Squad control point of every key
+    bool loop;
+    RotationInterpolation interpolation;
+};
+
+#endif
@@ -12,63 +12,88 @@ void Texture::bind(GLint textureSlot) const {
     glBindTexture(GL_TEXTURE_2D, m_texture);
 }
 
-std::weak_ptr<const Texture> TextureManager::addTexture(std::filesystem::path filePath) {
-    // Declare texture and load image from disk to CPU memory
-    Texture newTexture;
-    Image cpuTexture(filePath);
-
-    // Manually copy over string of filename
-    std::string tempName = filePath.filename().string();
-    newTexture.fileName.resize(tempName.length());
-    tempName.copy(newTexture.fileName.data(), tempName.length(), 0);
-
-    // Create texture with correct format, upload data, and generate mipmaps
-    glCreateTextures(GL_TEXTURE_2D, 1, &newTexture.m_texture);
+// Create texture with correct format, upload data, and generate mipmaps
+static void uploadTexture(Texture& texture, const Image& cpuTexture) {
+    glCreateTextures(GL_TEXTURE_2D, 1, &texture.m_texture);
     switch (cpuTexture.channels) {
         case 1:
-            glTextureStorage2D(newTexture.m_texture, 1, GL_R8, cpuTexture.width, cpuTexture.height);
-            glTextureSubImage2D(newTexture.m_texture, 0, 0, 0, cpuTexture.width, cpuTexture.height, GL_RED, GL_UNSIGNED_BYTE, cpuTexture.pixels.data());
+            glTextureStorage2D(texture.m_texture, 1, GL_R8, cpuTexture.width, cpuTexture.height);
+            glTextureSubImage2D(texture.m_texture, 0, 0, 0, cpuTexture.width, cpuTexture.height, GL_RED, GL_UNSIGNED_BYTE, cpuTexture.pixels().data());
             break;
         case 3:
-            glTextureStorage2D(newTexture.m_texture, 1, GL_RGB8, cpuTexture.width, cpuTexture.height);
-            glTextureSubImage2D(newTexture.m_texture, 0, 0, 0, cpuTexture.width, cpuTexture.height, GL_RGB, GL_UNSIGNED_BYTE, cpuTexture.pixels.data());
+            glTextureStorage2D(texture.m_texture, 1, GL_RGB8, cpuTexture.width, cpuTexture.height);
+            glTextureSubImage2D(texture.m_texture, 0, 0, 0, cpuTexture.width, cpuTexture.height, GL_RGB, GL_UNSIGNED_BYTE, cpuTexture.pixels().data());
             break;
         case 4:
-            glTextureStorage2D(newTexture.m_texture, 1, GL_RGBA8, cpuTexture.width, cpuTexture.height);
-            glTextureSubImage2D(newTexture.m_texture, 0, 0, 0, cpuTexture.width, cpuTexture.height, GL_RGBA, GL_UNSIGNED_BYTE, cpuTexture.pixels.data());
+            glTextureStorage2D(texture.m_texture, 1, GL_RGBA8, cpuTexture.width, cpuTexture.height);
+            glTextureSubImage2D(texture.m_texture, 0, 0, 0, cpuTexture.width, cpuTexture.height, GL_RGBA, GL_UNSIGNED_BYTE, cpuTexture.pixels().data());
             break;
         default:
             std::cerr << "Number of channels read for texture is not supported" << std::endl;
             throw std::exception();
     }
-    glGenerateTextureMipmap(newTexture.m_texture);
+    glGenerateTextureMipmap(texture.m_texture);
 
     // Set behavior for when texture coordinates are outside the [0, 1] range.
-    glTextureParameteri(newTexture.m_texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTextureParameteri(newTexture.m_texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTextureParameteri(texture.m_texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTextureParameteri(texture.m_texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
     // Set interpolation for texture sampling (mipmaps)
-    glTextureParameteri(newTexture.m_texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTextureParameteri(newTexture.m_texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(texture.m_texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTextureParameteri(texture.m_texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
 
-    // Create shared pointer managing the new texture and add it
-    textures.push_back(std::make_shared<Texture>(newTexture));
-    return textures.back();
+std::shared_ptr<Texture> TextureManager::makeNamedTexture(const std::filesystem::path& filePath) {
+    // Manually copy over string of filename
+    std::shared_ptr<Texture> newTexture = std::make_shared<Texture>();
+    std::string tempName                = filePath.filename().string();
+    newTexture->fileName.resize(tempName.length());
+    tempName.copy(newTexture->fileName.data(), tempName.length(), 0);
+    newTexture->sourcePath = filePath;
+    return newTexture;
 }
 
-bool TextureManager::removeTexture(std::string fileName) {
-    for (size_t idx = 0UL; idx < textures.size(); idx++) {
-        std::shared_ptr<Texture> tex = textures[idx];
-        if (fileName == tex->fileName) {
-            glDeleteTextures(1, &tex->m_texture);
-            textures.erase(textures.begin() + idx);
-            return true;
-        }
-    }
-    return false;
+std::weak_ptr<const Texture> TextureManager::addTexture(std::filesystem::path filePath) {
+    if (auto existing = textures.find(registryKey(filePath)); existing != textures.end()) { return existing->second; }
+
+    // Load image from disk to CPU memory and upload it
+    std::shared_ptr<Texture> newTexture = makeNamedTexture(filePath);
+    Image cpuTexture(filePath);
+    uploadTexture(*newTexture, cpuTexture);
+
+    textures[registryKey(filePath)] = newTexture;
+    return newTexture;
+}
+
+std::weak_ptr<const Texture> TextureManager::addMaterialTextureAsync(std::filesystem::path filePath, MaterialTextureType type, AssetLoader& assetLoader, AssetBundle& assetBundle) {
+    if (auto existing = textures.find(registryKey(filePath)); existing != textures.end()) { return existing->second; }
+
+    // Register the texture immediately so callers can hold on to it, then cook on a worker and attach the result on the GL thread
+    std::shared_ptr<Texture> newTexture = makeNamedTexture(filePath);
+    assetLoader.submitDetached([newTexture, filePath, type, &assetLoader, &assetBundle]() {
+        auto cookedTexture = std::make_shared<CookedTexture>(loadCookedTexture(filePath, type, assetBundle));
+        assetLoader.enqueueUpload([newTexture, cookedTexture]() { newTexture->cooked = std::move(*cookedTexture); });
+    });
+
+    textures[registryKey(filePath)] = newTexture;
+    return newTexture;
+}
+
+bool TextureManager::removeTexture(const std::filesystem::path& filePath) {
+    // Materials still using the texture keep it alive (and resident) until they stop being drawn
+    auto textureIter = textures.find(registryKey(filePath));
+    if (textureIter == textures.end()) { return false; }
+    if (textureIter->second->m_texture != Texture::INVALID) { glDeleteTextures(1, &textureIter->second->m_texture); }
+    textures.erase(textureIter);
+    return true;
+}
+
+std::weak_ptr<const Texture> TextureManager::getTexture(const std::filesystem::path& filePath) const {
+    auto textureIter = textures.find(registryKey(filePath));
+    return textureIter != textures.end() ? textureIter->second : std::weak_ptr<const Texture>();
 }
 
-std::weak_ptr<const Texture> TextureManager::getTexture(std::string fileName) const {
-    for (const std::shared_ptr<Texture> tex : textures) { if (fileName == tex->fileName) { return tex; } }
-    return std::weak_ptr<Texture>();
+std::string TextureManager::registryKey(const std::filesystem::path& filePath) {
+    // Many textures share a file name (e.g. every material's color_map.jpg), so textures are identified by their full path
+    return filePath.lexically_normal().generic_string();
 }
@@ -3,11 +3,16 @@
 
 #include <framework/opengl_includes.h>
 
+#include <render/asset_bundle.h>
+#include <render/asset_loader.h>
+#include <render/texture_cache.h>
 #include <exception>
 #include <filesystem>
 #include <functional>
 #include <optional>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 struct ImageLoadingException : public std::runtime_error {
@@ -20,16 +25,24 @@ struct Texture {
     static constexpr GLuint INVALID = 0xFFFFFFFF;
     GLuint m_texture { INVALID };
     std::string fileName;
+    std::filesystem::path sourcePath;
+    std::optional<CookedTexture> cooked; // Block-compressed mip chain, only present for material textures
 };
 
 class TextureManager {
 public:
     std::weak_ptr<const Texture> addTexture(std::filesystem::path filePath);
-    bool removeTexture(std::string fileName);
-    std::weak_ptr<const Texture> getTexture(std::string fileName) const;
+    // Material textures are only ever sampled through the material texture arrays, so they are cooked (see texture_cache.h) on a worker
+    // thread and get no standalone GL texture. The cooked data is attached once assetLoader drains the texture's upload
+    std::weak_ptr<const Texture> addMaterialTextureAsync(std::filesystem::path filePath, MaterialTextureType type, AssetLoader& assetLoader, AssetBundle& assetBundle);
+    bool removeTexture(const std::filesystem::path& filePath);
+    std::weak_ptr<const Texture> getTexture(const std::filesystem::path& filePath) const;
 
 private:
-    std::vector<std::shared_ptr<Texture>> textures;
+    static std::shared_ptr<Texture> makeNamedTexture(const std::filesystem::path& filePath);
+    static std::string registryKey(const std::filesystem::path& filePath);
+
+    std::unordered_map<std::string, std::shared_ptr<Texture>> textures;
 };
 
 #endif
@@ -0,0 +1,230 @@
+#include "texture_cache.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <fmt/format.h>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/type_precision.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+DISABLE_WARNINGS_POP()
+#include <framework/image.h>
+
+#include <render/texture.h>
+#include <utils/block_compression.hpp>
+#include <utils/cache_file.hpp>
+#include <utils/constants.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+// Bump whenever the resampling, mip generation, encoders, or file layout change so that stale cache entries are rebuilt
+static constexpr uint32_t COOKED_TEXTURE_MAGIC      = 0x5845544D; // "MTEX"
+static constexpr uint32_t COOKED_TEXTURE_VERSION    = 1U;
+
+// File layout: header, then every mip level's blocks from largest to smallest
+struct CookedTextureHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceHash;
+    uint32_t type;
+    uint32_t size;
+    uint32_t numLevels;
+    uint32_t padding;
+};
+static_assert(sizeof(CookedTextureHeader) == 32UL);
+
+GLenum CookedTexture::compressedFormat(MaterialTextureType type) {
+    switch (type) {
+        case MaterialTextureType::Color:    return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        case MaterialTextureType::Normal:   return GL_COMPRESSED_RG_RGTC2;
+        default:                            return GL_COMPRESSED_RED_RGTC1;
+    }
+}
+
+static uint32_t numMipLevels(uint32_t size) { return static_cast<uint32_t>(std::bit_width(size)); }
+
+size_t CookedTexture::levelByteSize(MaterialTextureType type, uint32_t size, uint32_t level) {
+    const size_t blocksPerRow   = (std::max(size >> level, 1U) + 3U) / 4U;
+    const size_t blockSize      = type == MaterialTextureType::Scalar ? 8UL : 16UL;
+    return blocksPerRow * blocksPerRow * blockSize;
+}
+
+static std::filesystem::path cachePath(uint64_t sourceHash, MaterialTextureType type) {
+    return utils::RESOURCES_DIR_PATH / "cache" / fmt::format("{:016x}-{}.tex", sourceHash, static_cast<uint32_t>(type));
+}
+
+// Source hash is checked separately, since bundled textures are matched by path instead
+static bool validCookedTexture(std::span<const std::byte> bytes, MaterialTextureType type) {
+    if (bytes.size() < sizeof(CookedTextureHeader)) { return false; }
+    const CookedTextureHeader& header = *reinterpret_cast<const CookedTextureHeader*>(bytes.data());
+    if (header.magic != COOKED_TEXTURE_MAGIC || header.version != COOKED_TEXTURE_VERSION ||
+        header.type != static_cast<uint32_t>(type) || header.size != static_cast<uint32_t>(utils::MATERIAL_TEXTURE_SIZE) ||
+        header.numLevels != numMipLevels(header.size)) { return false; }
+
+    size_t expectedSize = sizeof(CookedTextureHeader);
+    for (uint32_t level = 0U; level < header.numLevels; level++) { expectedSize += CookedTexture::levelByteSize(type, header.size, level); }
+    return bytes.size() == expectedSize;
+}
+
+static bool validCookedTexture(const MappedFile& file, uint64_t sourceHash, MaterialTextureType type) {
+    return validCookedTexture(file.bytes(), type) && reinterpret_cast<const CookedTextureHeader*>(file.bytes().data())->sourceHash == sourceHash;
+}
+
+// Point one span per level into the mapping
+static CookedTexture viewCookedTexture(std::shared_ptr<const MappedFile> file, std::span<const std::byte> bytes, MaterialTextureType type) {
+    const CookedTextureHeader& header   = *reinterpret_cast<const CookedTextureHeader*>(bytes.data());
+    size_t offset                       = sizeof(CookedTextureHeader);
+    CookedTexture cooked;
+    cooked.type = type;
+    for (uint32_t level = 0U; level < header.numLevels; level++) {
+        const size_t levelSize = CookedTexture::levelByteSize(type, header.size, level);
+        cooked.levels.push_back(bytes.subspan(offset, levelSize));
+        offset += levelSize;
+    }
+    cooked.file = std::move(file);
+    return cooked;
+}
+
+static AssetFormat bundleFormat(MaterialTextureType type) {
+    switch (type) {
+        case MaterialTextureType::Color:    return AssetFormat::ColorTexture;
+        case MaterialTextureType::Normal:   return AssetFormat::NormalTexture;
+        default:                            return AssetFormat::ScalarTexture;
+    }
+}
+
+// Normal maps are filtered as unit vectors rather than as colors
+static glm::vec4 decodeTexel(const glm::vec4& texel, MaterialTextureType type) {
+    if (type != MaterialTextureType::Normal) { return texel; }
+    return glm::vec4(glm::vec3(texel) * 2.0f - 1.0f, 0.0f);
+}
+
+static glm::vec4 normalizeTexel(const glm::vec4& texel, MaterialTextureType type) {
+    if (type != MaterialTextureType::Normal) { return texel; }
+    const float length = glm::length(glm::vec3(texel));
+    return length > 1e-6f ? texel / length : glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+}
+
+// Resample to size x size, averaging a grid of bilinear taps per texel so that downscaling larger sources does not alias
+static std::vector<glm::vec4> resample(const Image& image, uint32_t size, MaterialTextureType type) {
+    const glm::ivec2 tapsPerTexel = glm::max(glm::ivec2(glm::ceil(glm::vec2(image.width, image.height) / static_cast<float>(size))), glm::ivec2(1));
+    std::vector<glm::vec4> texels(static_cast<size_t>(size) * size);
+    for (uint32_t y = 0U; y < size; y++) {
+        for (uint32_t x = 0U; x < size; x++) {
+            glm::vec4 sum(0.0f);
+            for (int32_t tapY = 0; tapY < tapsPerTexel.y; tapY++) {
+                for (int32_t tapX = 0; tapX < tapsPerTexel.x; tapX++) {
+                    const glm::vec2 offset          = (glm::vec2(tapX, tapY) + 0.5f) / glm::vec2(tapsPerTexel);
+                    const glm::vec2 texCoords       = (glm::vec2(x, y) + offset) / static_cast<float>(size);
+                    sum                             += decodeTexel(image.sampleBilinear(texCoords), type);
+                }
+            }
+            texels[y * size + x] = normalizeTexel(sum / static_cast<float>(tapsPerTexel.x * tapsPerTexel.y), type);
+        }
+    }
+    return texels;
+}
+
+static std::vector<glm::vec4> downsample(const std::vector<glm::vec4>& texels, uint32_t size, MaterialTextureType type) {
+    const uint32_t halfSize = std::max(size / 2U, 1U);
+    std::vector<glm::vec4> halved(static_cast<size_t>(halfSize) * halfSize);
+    for (uint32_t y = 0U; y < halfSize; y++) {
+        for (uint32_t x = 0U; x < halfSize; x++) {
+            const uint32_t sourceX  = std::min(2U * x, size - 1U), sourceX1 = std::min(2U * x + 1U, size - 1U);
+            const uint32_t sourceY  = std::min(2U * y, size - 1U), sourceY1 = std::min(2U * y + 1U, size - 1U);
+            const glm::vec4 sum     = texels[sourceY * size + sourceX]  + texels[sourceY * size + sourceX1] +
+                                      texels[sourceY1 * size + sourceX] + texels[sourceY1 * size + sourceX1];
+            halved[y * halfSize + x] = normalizeTexel(sum / 4.0f, type);
+        }
+    }
+    return halved;
+}
+
+static void encodeLevel(const std::vector<glm::vec4>& texels, uint32_t size, MaterialTextureType type, std::ofstream& output) {
+    const auto toUnorm8 = [](float value) { return static_cast<uint8_t>(glm::round(glm::clamp(value, 0.0f, 1.0f) * 255.0f)); };
+
+    // Levels smaller than a block replicate their edge texels into the padding
+    for (uint32_t blockY = 0U; blockY < size; blockY += 4U) {
+        for (uint32_t blockX = 0U; blockX < size; blockX += 4U) {
+            utils::ColorBlock colorBlock;
+            utils::ScalarBlock redBlock, greenBlock;
+            for (uint32_t texelIdx = 0U; texelIdx < 16U; texelIdx++) {
+                const uint32_t x        = std::min(blockX + texelIdx % 4U, size - 1U);
+                const uint32_t y        = std::min(blockY + texelIdx / 4U, size - 1U);
+                const glm::vec4 texel   = type == MaterialTextureType::Normal ? texels[y * size + x] * 0.5f + 0.5f : texels[y * size + x];
+                colorBlock[texelIdx]    = glm::u8vec4(toUnorm8(texel.r), toUnorm8(texel.g), toUnorm8(texel.b), toUnorm8(texel.a));
+                redBlock[texelIdx]      = colorBlock[texelIdx].r;
+                greenBlock[texelIdx]    = colorBlock[texelIdx].g;
+            }
+
+            if (type == MaterialTextureType::Color) {
+                const std::array<uint8_t, 16UL> encoded = utils::encodeBC7Block(colorBlock);
+                output.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+            } else {
+                const std::array<uint8_t, 8UL> encodedRed = utils::encodeBC4Block(redBlock);
+                output.write(reinterpret_cast<const char*>(encodedRed.data()), encodedRed.size());
+                if (type == MaterialTextureType::Normal) {
+                    const std::array<uint8_t, 8UL> encodedGreen = utils::encodeBC4Block(greenBlock);
+                    output.write(reinterpret_cast<const char*>(encodedGreen.data()), encodedGreen.size());
+                }
+            }
+        }
+    }
+}
+
+static void cookTexture(const std::filesystem::path& imagePath, const std::filesystem::path& cookedPath, uint64_t sourceHash, MaterialTextureType type) {
+    const uint32_t size = static_cast<uint32_t>(utils::MATERIAL_TEXTURE_SIZE);
+    CookedTextureHeader header {};
+    header.magic        = COOKED_TEXTURE_MAGIC;
+    header.version      = COOKED_TEXTURE_VERSION;
+    header.sourceHash   = sourceHash;
+    header.type         = static_cast<uint32_t>(type);
+    header.size         = size;
+    header.numLevels    = numMipLevels(size);
+
+    const std::filesystem::path tempPath = utils::tempCachePath(cookedPath);
+    {
+        std::ofstream output(tempPath, std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        std::vector<glm::vec4> texels = resample(Image(imagePath), size, type);
+        for (uint32_t level = 0U; level < header.numLevels; level++) {
+            const uint32_t levelSize = std::max(size >> level, 1U);
+            encodeLevel(texels, levelSize, type, output);
+            if (level + 1U < header.numLevels) { texels = downsample(texels, levelSize, type); }
+        }
+        if (!output) { throw ImageLoadingException(fmt::format("Failed to write cooked texture {}", cookedPath.string())); }
+    }
+    std::filesystem::rename(tempPath, cookedPath);
+}
+
+CookedTexture loadCookedTexture(const std::filesystem::path& imagePath, MaterialTextureType type) {
+    if (!std::filesystem::exists(imagePath)) { throw ImageLoadingException(fmt::format("File {} does not exist", imagePath.string())); }
+
+    const uint64_t sourceHash               = utils::fnv1a64(MappedFile(imagePath).bytes());
+    const std::filesystem::path cookedPath  = cachePath(sourceHash, type);
+    MappedFile cookedFile;
+    if (std::filesystem::exists(cookedPath)) { cookedFile = MappedFile(cookedPath); }
+    if (!validCookedTexture(cookedFile, sourceHash, type)) {
+        std::cout << fmt::format("Cooking {}\n", imagePath.filename().string()) << std::flush;
+        cookTexture(imagePath, cookedPath, sourceHash, type);
+        cookedFile = MappedFile(cookedPath);
+        if (!validCookedTexture(cookedFile, sourceHash, type)) { throw ImageLoadingException(fmt::format("Cooked texture {} is invalid", cookedPath.string())); }
+    }
+
+    // Moving the mapping does not move the mapped memory, so the spans stay valid
+    auto sharedFile = std::make_shared<const MappedFile>(std::move(cookedFile));
+    return viewCookedTexture(sharedFile, sharedFile->bytes(), type);
+}
+
+CookedTexture loadCookedTexture(const std::filesystem::path& imagePath, MaterialTextureType type, AssetBundle& assetBundle) {
+    const std::optional<BundledAsset> bundled = assetBundle.find(imagePath, bundleFormat(type));
+    if (bundled.has_value() && validCookedTexture(bundled->bytes, type)) { return viewCookedTexture(bundled->file, bundled->bytes, type); }
+
+    CookedTexture cooked = loadCookedTexture(imagePath, type);
+    assetBundle.add(imagePath, bundleFormat(type), { cooked.file, cooked.file->bytes() });
+    return cooked;
+}
@@ -0,0 +1,44 @@
+#ifndef _TEXTURE_CACHE_H_
+#define _TEXTURE_CACHE_H_
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glad/glad.h>
+DISABLE_WARNINGS_POP()
+
+#include <render/asset_bundle.h>
+#include <utils/mapped_file.hpp>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <stdint.h>
+#include <vector>
+
+// How a texture is sampled by materials, which decides its block-compressed format
+enum class MaterialTextureType : uint32_t {
+    Color   = 0U,   // BC7 RGBA (albedo)
+    Normal  = 1U,   // BC5 RG (tangent-space normal maps, Z is reconstructed in the shader)
+    Scalar  = 2U    // BC4 R (metallic, roughness, AO, displacement)
+};
+constexpr size_t NUM_MATERIAL_TEXTURE_TYPES = 3UL;
+
+// Full mip chain of a texture resampled to MATERIAL_TEXTURE_SIZE and block-compressed, viewed directly from a memory-mapped cache
+// file or asset bundle
+struct CookedTexture {
+    std::shared_ptr<const MappedFile> file;
+    MaterialTextureType type;
+    std::vector<std::span<const std::byte>> levels; // Level 0 first
+
+    static GLenum compressedFormat(MaterialTextureType type);
+    static size_t levelByteSize(MaterialTextureType type, uint32_t size, uint32_t level);
+};
+
+// Loads an image through the cooked texture cache (resources/cache). On a miss the image is decoded, resampled, mipmapped (normal maps are
+// renormalised at every level), and compressed once and the result is written to the cache. Thread-safe, does not touch OpenGL
+[[nodiscard]] CookedTexture loadCookedTexture(const std::filesystem::path& imagePath, MaterialTextureType type);
+
+// Same as above, but served from the asset bundle when it holds an up-to-date copy (anything loaded otherwise is added to it)
+[[nodiscard]] CookedTexture loadCookedTexture(const std::filesystem::path& imagePath, MaterialTextureType type, AssetBundle& assetBundle);
+
+#endif
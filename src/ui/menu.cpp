@@ -181,6 +181,12 @@ void Menu::drawShadowTab() {
 
 void Menu::drawParticleParamControls() {
     ImGui::Checkbox("Draw all emitters", &m_renderConfig.drawParticleEmitters);
+    ImGui::Checkbox("GPU simulation", &m_renderConfig.gpuParticles);
+    ImGui::Checkbox("Order-independent transparency", &m_renderConfig.particleOIT);
+    ImGui::Checkbox("Frustum culling##particle", &m_renderConfig.particleCulling);
+    ImGui::SliderFloat("LOD near distance", &m_renderConfig.particleLodNear, 0.0f, 30.0f);
+    ImGui::SliderFloat("LOD far distance", &m_renderConfig.particleLodFar, 0.0f, 30.0f);
+    ImGui::SliderFloat("LOD minimum fraction", &m_renderConfig.particleLodMinFraction, 0.0f, 1.0f);
 
     ImGui::SliderFloat("Velocity deviation", &m_renderConfig.velocityDeviation, 0.0001f, 0.01f);
     ImGui::SliderFloat("Color deviation", &m_renderConfig.colorDeviation, 0.0f, 0.20f);
@@ -276,6 +282,12 @@ void Menu::drawShadingTab() {
     }
 }
 
+void Menu::drawGeometryControls() {
+    ImGui::Checkbox("GPU culling of static geometry", &m_renderConfig.enableGpuCulling);
+    ImGui::InputInt("Texture budget (MB)", &m_renderConfig.materialTextureBudgetMB, 16, 64);
+    ImGui::InputInt("Texture streaming (KB/frame)", &m_renderConfig.textureStreamingKBPerFrame, 256, 1024);
+}
+
 void Menu::drawHdrControls() {
     ImGui::Checkbox("Enable HDR", &m_renderConfig.enableHdr);
     ImGui::InputFloat("Exposure", &m_renderConfig.exposure, 0.1f, 1.0f, "%.1f");
@@ -306,6 +318,12 @@ void Menu::drawSSAOControls() {
 
 void Menu::drawRenderTab() {
     if (ImGui::BeginTabItem("Rendering")) {
+        ImGui::Text("Geometry");
+        drawGeometryControls();
+
+        ImGui::NewLine();
+        ImGui::Separator();
+
         ImGui::Text("HDR");
         drawHdrControls();
 
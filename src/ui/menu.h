@@ -53,6 +53,7 @@ private:
     void drawShadingTab();
 
     // Render tab
+    void drawGeometryControls();
     void drawHdrControls();
     void drawBloomControls();
     void drawParallaxControls();
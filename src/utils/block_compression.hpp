@@ -0,0 +1,181 @@
+#ifndef _BLOCK_COMPRESSION_HPP_
+#define _BLOCK_COMPRESSION_HPP_
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/type_precision.hpp>
+#include <glm/vec4.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <stdint.h>
+
+// Encoders for 4x4 texel blocks of the BCn formats used by the material texture arrays. Texels are given row by row
+namespace utils {
+    using ColorBlock    = std::array<glm::u8vec4, 16UL>;
+    using ScalarBlock   = std::array<uint8_t, 16UL>;
+
+    // Writes values LSB first, which is the bit order of every BCn block
+    class BlockBitWriter {
+    public:
+        void write(uint64_t value, uint32_t numBits) {
+            for (uint32_t bit = 0U; bit < numBits; bit++, bitPosition++) {
+                if ((value >> bit) & 1ULL) { bytes[bitPosition / 8U] |= static_cast<uint8_t>(1U << (bitPosition % 8U)); }
+            }
+        }
+
+        std::array<uint8_t, 16UL> bytes {};
+        uint32_t bitPosition { 0U };
+    };
+
+    // BC4 (RGTC1): two 8-bit endpoints and a 3-bit palette index per texel. Always uses the eight-value mode with endpoints at the block's
+    // extremes; palette entries 0 and 1 are the endpoints and entries 2-7 step from the first endpoint towards the second
+    static std::array<uint8_t, 8UL> encodeBC4Block(const ScalarBlock& block) {
+        const uint8_t maxValue = *std::max_element(block.begin(), block.end());
+        const uint8_t minValue = *std::min_element(block.begin(), block.end());
+
+        BlockBitWriter writer;
+        writer.write(maxValue, 8U);
+        writer.write(minValue, 8U);
+        for (uint8_t value : block) {
+            uint32_t index = 0U;
+            if (maxValue != minValue) {
+                const uint32_t step = static_cast<uint32_t>((7 * (maxValue - value) + (maxValue - minValue) / 2) / (maxValue - minValue));
+                index               = step == 0U ? 0U : step == 7U ? 1U : step + 1U;
+            }
+            writer.write(index, 3U);
+        }
+
+        std::array<uint8_t, 8UL> encoded;
+        std::copy_n(writer.bytes.begin(), encoded.size(), encoded.begin());
+        return encoded;
+    }
+
+    // BC7 mode 6 (one subset, RGBA endpoints with 7 bits plus a shared-per-endpoint p-bit, 4-bit indices). A single mode keeps the encoder
+    // small while still beating BC1/BC3 quality, which is plenty for the tiling PBR maps used here
+    namespace bc7 {
+        constexpr std::array<int32_t, 16UL> WEIGHTS = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        struct Endpoint {
+            glm::ivec4 quantized;   // 7 bits per channel
+            int32_t pBit;
+            glm::ivec4 value() const { return quantized * 2 + pBit; }
+        };
+
+        static Endpoint quantizeEndpoint(const glm::vec4& color) {
+            Endpoint best {};
+            float bestError = std::numeric_limits<float>::max();
+            for (int32_t pBit = 0; pBit < 2; pBit++) {
+                const glm::ivec4 quantized  = glm::clamp(glm::ivec4(glm::round((color - static_cast<float>(pBit)) / 2.0f)), 0, 127);
+                const glm::vec4 difference  = glm::vec4(quantized * 2 + pBit) - color;
+                const float error           = glm::dot(difference, difference);
+                if (error < bestError) {
+                    bestError   = error;
+                    best        = { quantized, pBit };
+                }
+            }
+            return best;
+        }
+
+        // Picks the nearest palette entry for every texel and returns the total squared error
+        static int64_t assignIndices(const ColorBlock& block, const Endpoint& first, const Endpoint& second, std::array<uint32_t, 16UL>& indices) {
+            std::array<glm::ivec4, 16UL> palette;
+            for (size_t entry = 0UL; entry < palette.size(); entry++) {
+                palette[entry] = ((64 - WEIGHTS[entry]) * first.value() + WEIGHTS[entry] * second.value() + 32) / 64;
+            }
+
+            int64_t totalError = 0;
+            for (size_t texel = 0UL; texel < block.size(); texel++) {
+                int32_t bestError = std::numeric_limits<int32_t>::max();
+                for (size_t entry = 0UL; entry < palette.size(); entry++) {
+                    const glm::ivec4 difference = glm::ivec4(block[texel]) - palette[entry];
+                    const int32_t error         = difference.x * difference.x + difference.y * difference.y +
+                                                  difference.z * difference.z + difference.w * difference.w;
+                    if (error < bestError) {
+                        bestError       = error;
+                        indices[texel]  = static_cast<uint32_t>(entry);
+                    }
+                }
+                totalError += bestError;
+            }
+            return totalError;
+        }
+    }
+
+    static std::array<uint8_t, 16UL> encodeBC7Block(const ColorBlock& block) {
+        // Endpoints start at the extremes of the block's projection onto its principal axis (power iteration on the covariance)
+        glm::vec4 mean(0.0f);
+        for (const glm::u8vec4& texel : block) { mean += glm::vec4(texel); }
+        mean /= 16.0f;
+        std::array<glm::vec4, 4UL> covariance {};
+        for (const glm::u8vec4& texel : block) {
+            const glm::vec4 offset = glm::vec4(texel) - mean;
+            for (int row = 0; row < 4; row++) { covariance[row] += offset[row] * offset; }
+        }
+        glm::vec4 axis(1.0f);
+        for (int iteration = 0; iteration < 8; iteration++) {
+            const glm::vec4 product = glm::vec4(glm::dot(covariance[0], axis), glm::dot(covariance[1], axis),
+                                                glm::dot(covariance[2], axis), glm::dot(covariance[3], axis));
+            const float length      = glm::length(product);
+            if (length < 1e-6f) { break; }
+            axis = product / length;
+        }
+        float minProjection = std::numeric_limits<float>::max(), maxProjection = std::numeric_limits<float>::lowest();
+        for (const glm::u8vec4& texel : block) {
+            const float projection  = glm::dot(glm::vec4(texel) - mean, axis);
+            minProjection           = std::min(minProjection, projection);
+            maxProjection           = std::max(maxProjection, projection);
+        }
+        bc7::Endpoint first     = bc7::quantizeEndpoint(glm::clamp(mean + minProjection * axis, 0.0f, 255.0f));
+        bc7::Endpoint second    = bc7::quantizeEndpoint(glm::clamp(mean + maxProjection * axis, 0.0f, 255.0f));
+        std::array<uint32_t, 16UL> indices;
+        int64_t error           = bc7::assignIndices(block, first, second, indices);
+
+        // Refine endpoints once with a least-squares fit to the chosen indices, keeping the result only if it helps
+        float sumAA = 0.0f, sumAB = 0.0f, sumBB = 0.0f;
+        glm::vec4 sumAX(0.0f), sumBX(0.0f);
+        for (size_t texel = 0UL; texel < block.size(); texel++) {
+            const float b   = static_cast<float>(bc7::WEIGHTS[indices[texel]]) / 64.0f;
+            const float a   = 1.0f - b;
+            sumAA += a * a; sumAB += a * b; sumBB += b * b;
+            sumAX += a * glm::vec4(block[texel]);
+            sumBX += b * glm::vec4(block[texel]);
+        }
+        const float determinant = sumAA * sumBB - sumAB * sumAB;
+        if (std::abs(determinant) > 1e-6f) {
+            const bc7::Endpoint refinedFirst    = bc7::quantizeEndpoint(glm::clamp((sumBB * sumAX - sumAB * sumBX) / determinant, 0.0f, 255.0f));
+            const bc7::Endpoint refinedSecond   = bc7::quantizeEndpoint(glm::clamp((sumAA * sumBX - sumAB * sumAX) / determinant, 0.0f, 255.0f));
+            std::array<uint32_t, 16UL> refinedIndices;
+            const int64_t refinedError          = bc7::assignIndices(block, refinedFirst, refinedSecond, refinedIndices);
+            if (refinedError < error) {
+                first   = refinedFirst;
+                second  = refinedSecond;
+                indices = refinedIndices;
+                error   = refinedError;
+            }
+        }
+
+        // The first texel's index is stored with its top bit implied to be 0, so swap endpoints if needed
+        if (indices[0] >= 8U) {
+            std::swap(first, second);
+            for (uint32_t& index : indices) { index = 15U - index; }
+        }
+
+        BlockBitWriter writer;
+        writer.write(1U << 6U, 7U); // Mode 6
+        for (int channel = 0; channel < 4; channel++) {
+            writer.write(static_cast<uint64_t>(first.quantized[channel]), 7U);
+            writer.write(static_cast<uint64_t>(second.quantized[channel]), 7U);
+        }
+        writer.write(static_cast<uint64_t>(first.pBit), 1U);
+        writer.write(static_cast<uint64_t>(second.pBit), 1U);
+        for (size_t texel = 0UL; texel < indices.size(); texel++) { writer.write(indices[texel], texel == 0UL ? 3U : 4U); }
+        return writer.bytes;
+    }
+}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef _CACHE_FILE_HPP_
+#define _CACHE_FILE_HPP_
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <fmt/format.h>
+DISABLE_WARNINGS_POP()
+
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+namespace utils {
+    // Cooked cache entries are written to a temporary file first so that an interrupted write never leaves a truncated entry behind.
+    // The name is unique per thread since identical source files (same hash) may be cooked concurrently by the asset loader
+    inline std::filesystem::path tempCachePath(const std::filesystem::path& cookedPath) {
+        std::filesystem::create_directories(cookedPath.parent_path());
+        const size_t threadHash = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        return fmt::format("{}.{:x}.tmp", cookedPath.string(), threadHash);
+    }
+}
+
+#endif
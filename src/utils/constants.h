@@ -19,6 +19,17 @@ namespace utils {
     constexpr int32_t G_BUFFER_TEX_START_IDX        = 48;
     constexpr int32_t HDR_BUFFER_TEX_START_IDX      = 56;
 
+    // Geometry arena parameters (buffers grow past these if needed)
+    constexpr size_t GEOMETRY_ARENA_INITIAL_VERTICES    = 1UL << 18UL;
+    constexpr size_t GEOMETRY_ARENA_INITIAL_INDEX_BYTES = 1UL << 22UL;
+
+    // Asset loading parameters (caps decoded assets waiting for upload, bounding peak memory during loading)
+    constexpr size_t ASSET_UPLOAD_QUEUE_CAPACITY = 8UL;
+
+    // Material texture arrays parameters (every material texture is resampled to this resolution)
+    constexpr int32_t MATERIAL_TEXTURE_SIZE                     = 1024;
+    constexpr int32_t MATERIAL_TEXTURE_INITIAL_RESIDENT_SIZE    = 64;   // Mips up to this size are uploaded as soon as a texture gets a layer, larger ones are streamed
+
     // Shadow maps parameters
     constexpr int32_t SHADOWTEX_WIDTH               = 1024;
     constexpr int32_t SHADOWTEX_HEIGHT              = 1024;
@@ -27,6 +38,9 @@ namespace utils {
     constexpr float CUBE_SHADOW_FOV                 = 90.0f; // Must be 90 degrees so that the cameras on the six sides of the cube touch each other
     constexpr glm::vec3 CONSTANT_AREA_LIGHT_FALLOFF = { -1.0f, 0.0f, 0.0f };
 
+    // Animation parameters
+    constexpr uint32_t BEZIER_ARC_LENGTH_SAMPLES = 32U; // Arc length table entries per curve for constant-speed motion
+
     // Particles parameters
     constexpr size_t MAX_PARTICLES_PER_EMITTER = 512UL;
 
@@ -35,6 +49,10 @@ namespace utils {
     constexpr float TILE_LENGTH_X   = 7.72f;
     constexpr float TILE_LENGTH_Z   = 7.72f;
 
+    // Simulation parameters
+    constexpr float SIMULATION_TIMESTEP                 = 1.0f / 60.0f; // Seconds per simulation step, independent of the frame rate
+    constexpr uint32_t MAX_SIMULATION_STEPS_PER_FRAME   = 8U;           // Frames which would need more steps drop the excess time, slowing gameplay down instead of stalling
+
     // Gameplay parameters
     constexpr uint32_t NUM_HEADS_TO_COLLECT         = 7UL;
     constexpr float CUTSCENE_POSITION_OFFSET        = 3.0f;
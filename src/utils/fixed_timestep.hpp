@@ -0,0 +1,42 @@
+#ifndef _FIXED_TIMESTEP_HPP_
+#define _FIXED_TIMESTEP_HPP_
+
+#include <algorithm>
+#include <stdint.h>
+
+namespace utils {
+    // Turns variable frame times into a whole number of fixed simulation steps. The time left over after the last step is kept
+    // for the next frame and, as a fraction of a step, tells rendering how far to interpolate from the previous simulated state to
+    // the latest one
+    class FixedTimestep {
+    public:
+        FixedTimestep(float stepSeconds, uint32_t maxStepsPerFrame) : m_step(stepSeconds), m_maxSteps(maxStepsPerFrame) {}
+
+        // Number of steps to simulate for a frame which took frameSeconds
+        uint32_t advance(float frameSeconds) {
+            m_accumulator           += std::max(frameSeconds, 0.0f);
+            const uint32_t numSteps = static_cast<uint32_t>(m_accumulator / m_step);
+            m_accumulator           -= static_cast<float>(numSteps) * m_step;
+            if (numSteps > m_maxSteps) { m_accumulator = 0.0f; }
+
+            const uint32_t simulatedSteps = std::min(numSteps, m_maxSteps);
+            m_numSteps += simulatedSteps;
+            return simulatedSteps;
+        }
+
+        float step() const          { return m_step; }
+        float interpolation() const { return std::clamp(m_accumulator / m_step, 0.0f, 1.0f); }
+
+        // Simulated time in seconds after the latest step, and the (one step older) time matching the interpolated render state
+        float time() const          { return static_cast<float>(m_numSteps) * m_step; }
+        float renderTime() const    { return std::max(time() - (1.0f - interpolation()) * m_step, 0.0f); }
+
+    private:
+        float m_step;
+        uint32_t m_maxSteps;
+        float m_accumulator { 0.0f };
+        uint64_t m_numSteps { 0UL };
+    };
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef _FREE_LIST_HPP_
+#define _FREE_LIST_HPP_
+
+#include <iterator>
+#include <map>
+#include <optional>
+
+namespace utils {
+    // First-fit allocator over an abstract range [0, capacity). Only tracks offsets; storage is owned by the caller
+    class FreeListAllocator {
+    public:
+        FreeListAllocator() = default;
+        explicit FreeListAllocator(size_t capacity) { grow(capacity); }
+
+        size_t capacity() const { return m_capacity; }
+
+        // Returns the offset of a free block of the given size (aligned to the given alignment), or nothing if no block fits
+        std::optional<size_t> allocate(size_t size, size_t alignment = 1UL) {
+            if (size == 0UL) { return 0UL; }
+            for (auto blockIter = m_freeBlocks.begin(); blockIter != m_freeBlocks.end(); blockIter++) {
+                const size_t blockStart   = blockIter->first;
+                const size_t blockEnd     = blockStart + blockIter->second;
+                const size_t alignedStart = ((blockStart + alignment - 1UL) / alignment) * alignment;
+                if (alignedStart + size > blockEnd) { continue; }
+
+                // Split block into (optional) leading padding, allocated range, and (optional) trailing remainder
+                m_freeBlocks.erase(blockIter);
+                if (alignedStart > blockStart)      { m_freeBlocks[blockStart]          = alignedStart - blockStart; }
+                if (alignedStart + size < blockEnd) { m_freeBlocks[alignedStart + size] = blockEnd - (alignedStart + size); }
+                return alignedStart;
+            }
+            return std::nullopt;
+        }
+
+        // Return a previously allocated range, merging it with adjacent free blocks
+        void free(size_t offset, size_t size) {
+            if (size == 0UL) { return; }
+            auto [blockIter, inserted] = m_freeBlocks.emplace(offset, size);
+
+            // Merge with next block
+            auto nextIter = std::next(blockIter);
+            if (nextIter != m_freeBlocks.end() && blockIter->first + blockIter->second == nextIter->first) {
+                blockIter->second += nextIter->second;
+                m_freeBlocks.erase(nextIter);
+            }
+
+            // Merge with previous block
+            if (blockIter != m_freeBlocks.begin()) {
+                auto prevIter = std::prev(blockIter);
+                if (prevIter->first + prevIter->second == blockIter->first) {
+                    prevIter->second += blockIter->second;
+                    m_freeBlocks.erase(blockIter);
+                }
+            }
+        }
+
+        // Extend the range to the new capacity; the added space becomes a free block
+        void grow(size_t newCapacity) {
+            if (newCapacity <= m_capacity) { return; }
+            const size_t oldCapacity = m_capacity;
+            m_capacity = newCapacity;
+            free(oldCapacity, newCapacity - oldCapacity);
+        }
+
+    private:
+        std::map<size_t, size_t> m_freeBlocks; // Offset -> size, ordered by offset so neighbours can be coalesced
+        size_t m_capacity { 0UL };
+    };
+}
+
+#endif
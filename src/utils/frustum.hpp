@@ -0,0 +1,45 @@
+#ifndef _FRUSTUM_HPP_
+#define _FRUSTUM_HPP_
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/geometric.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <array>
+
+namespace utils {
+    // View frustum as six inward-facing planes (XYZ is the plane normal, W is the distance term)
+    struct Frustum {
+        std::array<glm::vec4, 6UL> planes;
+
+        // Gribb-Hartmann plane extraction (https://www.gamedevs.org/uploads/fast-extraction-viewing-frustum-planes-from-world-view-projection-matrix.pdf)
+        static Frustum fromViewProjection(const glm::mat4& viewProjection) {
+            const glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+            const glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+            const glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+            const glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+            Frustum frustum { .planes = { row3 + row0,      // Left
+                                          row3 - row0,      // Right
+                                          row3 + row1,      // Bottom
+                                          row3 - row1,      // Top
+                                          row3 + row2,      // Near
+                                          row3 - row2 } };  // Far
+            for (glm::vec4& plane : frustum.planes) { plane /= glm::length(glm::vec3(plane)); }
+            return frustum;
+        }
+
+        bool intersectsSphere(const glm::vec3& center, float radius) const {
+            for (const glm::vec4& plane : planes) {
+                if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) { return false; }
+            }
+            return true;
+        }
+    };
+}
+
+#endif
@@ -3,10 +3,12 @@
 
 #include <framework/disable_all_warnings.h>
 DISABLE_WARNINGS_PUSH()
+#include <glm/common.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <glm/mat4x4.hpp>
 DISABLE_WARNINGS_POP()
+#include <framework/mesh.h>
 
 #include <array>
 
@@ -46,22 +48,24 @@ struct HitBox {
 
     static HitBox makeHitBox(const Mesh& cpuMesh, bool allowCollision) {
         // Finding minimum and maximum coordinates of X, Y, and Z axes
-        std::array<std::array<float, 3>, 2> minMax{};
-        for (Vertex vertex : cpuMesh.vertices) {
-            if (vertex.position.x < minMax[0][0]) { minMax[0][0] = vertex.position.x; }
-            if (vertex.position.x > minMax[1][0]) { minMax[1][0] = vertex.position.x; }
-            if (vertex.position.y < minMax[0][1]) { minMax[0][1] = vertex.position.y; }
-            if (vertex.position.y > minMax[1][1]) { minMax[1][1] = vertex.position.y; }
-            if (vertex.position.z < minMax[0][2]) { minMax[0][2] = vertex.position.z; }
-            if (vertex.position.z > minMax[1][2]) { minMax[1][2] = vertex.position.z; }
+        glm::vec3 boundsMin(0.0f), boundsMax(0.0f);
+        for (const Vertex& vertex : cpuMesh.vertices) {
+            boundsMin = glm::min(boundsMin, vertex.position);
+            boundsMax = glm::max(boundsMax, vertex.position);
         }
+        return makeHitBox(boundsMin, boundsMax, allowCollision);
+    }
+
+    // Box always encloses the model-space origin, matching hitboxes built by scanning vertices
+    static HitBox makeHitBox(const glm::vec3& boundsMin, const glm::vec3& boundsMax, bool allowCollision) {
+        const std::array<glm::vec3, 2> minMax = { glm::min(boundsMin, glm::vec3(0.0f)), glm::max(boundsMax, glm::vec3(0.0f)) };
 
         // Create bounding box from extreme points
         std::array<glm::vec3, 8> points = {};
         for (int z = 0; z < 2; ++z) {
             for (int y = 0; y < 2; ++y) {
                 for (int x = 0; x < 2; ++x) {
-                    points[x + y * 2 + z * 4] = glm::vec3(minMax[x][0], minMax[y][1], minMax[z][2]);
+                    points[x + y * 2 + z * 4] = glm::vec3(minMax[x].x, minMax[y].y, minMax[z].z);
                 }
             }
         }
@@ -0,0 +1,170 @@
+#ifndef _JOB_SYSTEM_HPP_
+#define _JOB_SYSTEM_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace utils {
+    // Unit of work for the JobSystem. A job becomes runnable once all of its dependencies have finished
+    struct Job {
+        std::function<void()> task;
+        std::atomic<uint32_t> pendingDependencies   { 1U };     // The extra count is held by JobSystem::schedule while it registers dependencies
+        std::atomic<bool> finished                  { false };  // Only set while holding dependentsMutex, so dependents are never missed
+        std::mutex dependentsMutex;
+        std::vector<std::shared_ptr<Job>> dependents;
+    };
+    using JobHandle = std::shared_ptr<Job>;
+
+    // Work-stealing scheduler. Every worker owns a deque: it pushes and pops its own jobs at the back (most recent work, likely still
+    // in cache) while idle threads steal from the front of the others (oldest work, usually the largest remaining piece). Threads
+    // which are not workers, such as the main thread, share one extra deque and help executing jobs while they wait for one.
+    // Only a single instance is supported, since deque ownership is tracked per thread
+    class JobSystem {
+    public:
+        explicit JobSystem(size_t numWorkers = std::max(std::thread::hardware_concurrency(), 2U) - 1U) : m_queues(numWorkers + 1UL) {
+            m_workers.reserve(numWorkers);
+            for (size_t queueIdx = 1UL; queueIdx <= numWorkers; queueIdx++) { m_workers.emplace_back([this, queueIdx] { workerLoop(queueIdx); }); }
+        }
+        ~JobSystem() {
+            {
+                std::lock_guard lock(m_sleepMutex);
+                m_stopping = true;
+            }
+            m_wakeUp.notify_all();
+            for (std::thread& worker : m_workers) { worker.join(); }
+        }
+        JobSystem(const JobSystem&)             = delete;
+        JobSystem& operator=(const JobSystem&)  = delete;
+
+        // Workers plus the calling thread
+        size_t numThreads() const { return m_queues.size(); }
+
+        // Run task once all dependencies have finished
+        JobHandle schedule(std::function<void()> task, std::span<const JobHandle> dependencies = {}) {
+            JobHandle job   = std::make_shared<Job>();
+            job->task       = std::move(task);
+            for (const JobHandle& dependency : dependencies) {
+                std::lock_guard lock(dependency->dependentsMutex);
+                if (dependency->finished) { continue; }
+                job->pendingDependencies++;
+                dependency->dependents.push_back(job);
+            }
+            if (--job->pendingDependencies == 0U) { enqueue(job); }
+            return job;
+        }
+
+        // Calls body(begin, end) on chunks of at most grainSize indices of [0, count). The returned job finishes with the last chunk.
+        // A single chunk without dependencies runs directly on the calling thread
+        JobHandle parallelFor(size_t count, size_t grainSize, std::function<void(size_t, size_t)> body, std::span<const JobHandle> dependencies = {}) {
+            grainSize               = std::max<size_t>(grainSize, 1);
+            const size_t numChunks  = (count + grainSize - 1UL) / grainSize;
+            if (numChunks <= 1UL && dependencies.empty()) {
+                if (count > 0UL) { body(0UL, count); }
+                JobHandle done  = std::make_shared<Job>();
+                done->finished  = true;
+                return done;
+            }
+
+            const auto sharedBody = std::make_shared<std::function<void(size_t, size_t)>>(std::move(body));
+            std::vector<JobHandle> chunks;
+            chunks.reserve(numChunks);
+            for (size_t begin = 0UL; begin < count; begin += grainSize) {
+                const size_t end = std::min(begin + grainSize, count);
+                chunks.push_back(schedule([sharedBody, begin, end] { (*sharedBody)(begin, end); }, dependencies));
+            }
+            return schedule([] {}, chunks);
+        }
+
+        // Blocks until the job has finished, executing other jobs in the meantime (so waiting from inside a job cannot deadlock)
+        void wait(const JobHandle& job) {
+            while (!job->finished.load(std::memory_order_acquire)) {
+                if (JobHandle other = findJob())    { execute(other); }
+                else                                { std::this_thread::yield(); }
+            }
+        }
+
+    private:
+        struct WorkQueue {
+            std::mutex mutex;
+            std::deque<JobHandle> jobs;
+        };
+
+        static inline thread_local size_t t_queueIdx = 0UL; // Deque owned by the current thread (0 for every non-worker)
+
+        void enqueue(const JobHandle& job) {
+            WorkQueue& queue = m_queues[t_queueIdx];
+            {
+                std::lock_guard lock(queue.mutex);
+                queue.jobs.push_back(job);
+            }
+            {
+                // Counted under the sleep mutex, so a worker cannot miss the notification between checking and going to sleep
+                std::lock_guard lock(m_sleepMutex);
+                m_numQueued++;
+            }
+            m_wakeUp.notify_one();
+        }
+
+        JobHandle findJob() {
+            for (size_t offset = 0UL; offset < m_queues.size(); offset++) {
+                WorkQueue& queue = m_queues[(t_queueIdx + offset) % m_queues.size()];
+                std::lock_guard lock(queue.mutex);
+                if (queue.jobs.empty()) { continue; }
+
+                JobHandle job;
+                if (offset == 0UL)  { job = std::move(queue.jobs.back());   queue.jobs.pop_back(); }
+                else                { job = std::move(queue.jobs.front());  queue.jobs.pop_front(); }
+                m_numQueued--;
+                return job;
+            }
+            return nullptr;
+        }
+
+        void execute(const JobHandle& job) {
+            job->task();
+            job->task = nullptr; // Release captured state as soon as possible
+
+            std::vector<JobHandle> dependents;
+            {
+                std::lock_guard lock(job->dependentsMutex);
+                job->finished.store(true, std::memory_order_release);
+                dependents.swap(job->dependents);
+            }
+            for (const JobHandle& dependent : dependents) {
+                if (--dependent->pendingDependencies == 0U) { enqueue(dependent); }
+            }
+        }
+
+        void workerLoop(size_t queueIdx) {
+            t_queueIdx = queueIdx;
+            while (true) {
+                if (JobHandle job = findJob()) {
+                    execute(job);
+                    continue;
+                }
+
+                std::unique_lock lock(m_sleepMutex);
+                m_wakeUp.wait(lock, [this] { return m_stopping || m_numQueued > 0UL; });
+                if (m_stopping && m_numQueued == 0UL) { return; }
+            }
+        }
+
+        std::vector<WorkQueue> m_queues;
+        std::vector<std::thread> m_workers;
+        std::atomic<size_t> m_numQueued { 0UL };
+        std::mutex m_sleepMutex;
+        std::condition_variable m_wakeUp;
+        bool m_stopping { false };
+    };
+}
+
+#endif
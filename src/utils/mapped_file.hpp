@@ -0,0 +1,135 @@
+#ifndef _MAPPED_FILE_HPP_
+#define _MAPPED_FILE_HPP_
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+
+struct MappedFileException : public std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+// Read-only memory mapping of an entire file. Pages are loaded lazily by the OS, so mapping is cheap even for large files
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& filePath) {
+#ifdef _WIN32
+        m_file = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) { throw MappedFileException("Failed to open " + filePath.string()); }
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(m_file, &fileSize);
+        m_size = static_cast<size_t>(fileSize.QuadPart);
+        if (m_size > 0UL) {
+            m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (m_mapping == nullptr) { close(); throw MappedFileException("Failed to map " + filePath.string()); }
+            m_data = static_cast<const std::byte*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+#else
+        m_file = open(filePath.c_str(), O_RDONLY);
+        if (m_file < 0) { throw MappedFileException("Failed to open " + filePath.string()); }
+        struct stat fileStats;
+        fstat(m_file, &fileStats);
+        m_size = static_cast<size_t>(fileStats.st_size);
+        if (m_size > 0UL) {
+            void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+            if (mapping == MAP_FAILED) { close(); throw MappedFileException("Failed to map " + filePath.string()); }
+            m_data = static_cast<const std::byte*>(mapping);
+        }
+#endif
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept { moveInto(std::move(other)); }
+    ~MappedFile() { close(); }
+
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            moveInto(std::move(other));
+        }
+        return *this;
+    }
+
+    std::span<const std::byte> bytes() const { return { m_data, m_size }; }
+    size_t size() const { return m_size; }
+
+    // Hint that the whole file is about to be read front to back, so the OS reads it ahead in large sequential chunks
+    // instead of faulting pages in one at a time (no-op on Windows, which already reads ahead on sequential faults)
+    void prefetch() const {
+#ifndef _WIN32
+        if (m_data == nullptr) { return; }
+        posix_madvise(const_cast<std::byte*>(m_data), m_size, POSIX_MADV_SEQUENTIAL);
+        posix_madvise(const_cast<std::byte*>(m_data), m_size, POSIX_MADV_WILLNEED);
+#endif
+    }
+
+private:
+    void close() {
+#ifdef _WIN32
+        if (m_data != nullptr)                  { UnmapViewOfFile(m_data); }
+        if (m_mapping != nullptr)               { CloseHandle(m_mapping); }
+        if (m_file != INVALID_HANDLE_VALUE)     { CloseHandle(m_file); }
+        m_mapping   = nullptr;
+        m_file      = INVALID_HANDLE_VALUE;
+#else
+        if (m_data != nullptr)  { munmap(const_cast<std::byte*>(m_data), m_size); }
+        if (m_file >= 0)        { ::close(m_file); }
+        m_file = -1;
+#endif
+        m_data = nullptr;
+        m_size = 0UL;
+    }
+
+    void moveInto(MappedFile&& other) {
+        m_data  = other.m_data;
+        m_size  = other.m_size;
+        m_file  = other.m_file;
+#ifdef _WIN32
+        m_mapping       = other.m_mapping;
+        other.m_mapping = nullptr;
+        other.m_file    = INVALID_HANDLE_VALUE;
+#else
+        other.m_file    = -1;
+#endif
+        other.m_data = nullptr;
+        other.m_size = 0UL;
+    }
+
+    const std::byte* m_data { nullptr };
+    size_t m_size           { 0UL };
+#ifdef _WIN32
+    HANDLE m_file           { INVALID_HANDLE_VALUE };
+    HANDLE m_mapping        { nullptr };
+#else
+    int m_file              { -1 };
+#endif
+};
+
+namespace utils {
+    // 64-bit FNV-1a (http://www.isthe.com/chongo/tech/comp/fnv/)
+    inline uint64_t fnv1a64(std::span<const std::byte> bytes, uint64_t hash = 0xcbf29ce484222325ULL) {
+        for (std::byte value : bytes) {
+            hash ^= static_cast<uint64_t>(value);
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+}
+
+#endif
@@ -0,0 +1,262 @@
+#ifndef _MESH_OPTIMIZER_HPP_
+#define _MESH_OPTIMIZER_HPP_
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+DISABLE_WARNINGS_POP()
+#include <framework/mesh.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <deque>
+#include <numeric>
+#include <stdint.h>
+#include <vector>
+
+namespace utils {
+    constexpr size_t VERTEX_CACHE_SIZE              = 32UL;     // Post-transform cache size assumed by the optimizer and ACMR simulation
+    constexpr float OVERDRAW_ACMR_THRESHOLD         = 1.05f;    // Overdraw ordering is rejected if it degrades ACMR by more than this factor
+
+    struct MeshOptimizationStats {
+        float acmrBefore;
+        float acmrAfter;
+    };
+
+    /********** Vertex cache simulation **********/
+    // Average cache miss ratio (transformed vertices per triangle) of a FIFO cache
+    static float computeACMR(const std::vector<glm::uvec3>& triangles, size_t numVertices) {
+        if (triangles.empty()) { return 0.0f; }
+        std::vector<size_t> insertionTime(numVertices, 0UL); // 0 means never inserted
+        size_t time = VERTEX_CACHE_SIZE + 1UL, misses = 0UL;
+        for (const glm::uvec3& triangle : triangles) {
+            for (int vertexIdx = 0; vertexIdx < 3; vertexIdx++) {
+                size_t& inserted = insertionTime[triangle[vertexIdx]];
+                if (inserted == 0UL || time - inserted > VERTEX_CACHE_SIZE) {
+                    inserted = time++;
+                    misses++;
+                }
+            }
+        }
+        return static_cast<float>(misses) / static_cast<float>(triangles.size());
+    }
+
+    /********** Vertex cache optimization **********/
+    // Tom Forsyth's linear-speed vertex cache optimisation (https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html)
+    static float forsythVertexScore(int32_t cachePosition, uint32_t remainingTriangles) {
+        constexpr float CACHE_DECAY_POWER   = 1.5f;
+        constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+        constexpr float VALENCE_BOOST_SCALE = 2.0f;
+        constexpr float VALENCE_BOOST_POWER = 0.5f;
+        if (remainingTriangles == 0U) { return -1.0f; }
+
+        float score = 0.0f;
+        if (cachePosition >= 0) {
+            // Vertices of the most recent triangle are scored equally so that the order within a triangle does not matter
+            if (cachePosition < 3)  { score = LAST_TRIANGLE_SCORE; }
+            else                    { score = std::pow(1.0f - static_cast<float>(cachePosition - 3) / static_cast<float>(VERTEX_CACHE_SIZE - 3UL), CACHE_DECAY_POWER); }
+        }
+
+        // Boost vertices with few remaining triangles so that lone triangles are not left behind
+        score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+        return score;
+    }
+
+    static std::vector<glm::uvec3> optimizeVertexCache(const std::vector<glm::uvec3>& triangles, size_t numVertices) {
+        const size_t numTriangles = triangles.size();
+
+        // Vertex -> triangle adjacency (compressed rows)
+        std::vector<uint32_t> adjacencyOffsets(numVertices + 1UL, 0U);
+        for (const glm::uvec3& triangle : triangles) { for (int i = 0; i < 3; i++) { adjacencyOffsets[triangle[i] + 1UL]++; } }
+        std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+        std::vector<uint32_t> adjacency(adjacencyOffsets.back());
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (uint32_t triIdx = 0U; triIdx < numTriangles; triIdx++) {
+            for (int i = 0; i < 3; i++) { adjacency[fill[triangles[triIdx][i]]++] = triIdx; }
+        }
+
+        // Per-vertex and per-triangle scores
+        std::vector<uint32_t> remaining(numVertices);
+        std::vector<int32_t> cachePosition(numVertices, -1);
+        std::vector<float> vertexScores(numVertices);
+        for (size_t vertexIdx = 0UL; vertexIdx < numVertices; vertexIdx++) {
+            remaining[vertexIdx]    = adjacencyOffsets[vertexIdx + 1UL] - adjacencyOffsets[vertexIdx];
+            vertexScores[vertexIdx] = forsythVertexScore(-1, remaining[vertexIdx]);
+        }
+        std::vector<float> triangleScores(numTriangles);
+        std::vector<bool> emitted(numTriangles, false);
+        for (size_t triIdx = 0UL; triIdx < numTriangles; triIdx++) {
+            const glm::uvec3& triangle  = triangles[triIdx];
+            triangleScores[triIdx]      = vertexScores[triangle.x] + vertexScores[triangle.y] + vertexScores[triangle.z];
+        }
+
+        std::vector<glm::uvec3> result;
+        result.reserve(numTriangles);
+        std::vector<uint32_t> cache, newCache;
+        size_t fallbackCursor   = 0UL;
+        int64_t bestTriangle    = -1;
+        while (result.size() < numTriangles) {
+            // No candidate among cached vertices, fall back to the best remaining triangle
+            if (bestTriangle < 0) {
+                float bestScore = -1.0f;
+                for (size_t triIdx = fallbackCursor; triIdx < numTriangles; triIdx++) {
+                    if (!emitted[triIdx] && triangleScores[triIdx] > bestScore) {
+                        bestScore       = triangleScores[triIdx];
+                        bestTriangle    = static_cast<int64_t>(triIdx);
+                    }
+                }
+                while (fallbackCursor < numTriangles && emitted[fallbackCursor]) { fallbackCursor++; }
+            }
+
+            // Emit triangle and remove it from its vertices' adjacency
+            const glm::uvec3& triangle = triangles[bestTriangle];
+            result.push_back(triangle);
+            emitted[bestTriangle] = true;
+            for (int i = 0; i < 3; i++) {
+                const uint32_t vertex   = triangle[i];
+                const uint32_t begin    = adjacencyOffsets[vertex];
+                const uint32_t end      = begin + remaining[vertex];
+                std::iter_swap(std::find(adjacency.begin() + begin, adjacency.begin() + end, static_cast<uint32_t>(bestTriangle)), adjacency.begin() + end - 1);
+                remaining[vertex]--;
+            }
+
+            // Move triangle's vertices to the front of the LRU cache
+            newCache.assign({ triangle.x, triangle.y, triangle.z });
+            for (uint32_t vertex : cache) { if (vertex != triangle.x && vertex != triangle.y && vertex != triangle.z) { newCache.push_back(vertex); } }
+            for (size_t cacheIdx = 0UL; cacheIdx < newCache.size(); cacheIdx++) {
+                cachePosition[newCache[cacheIdx]] = cacheIdx < VERTEX_CACHE_SIZE ? static_cast<int32_t>(cacheIdx) : -1;
+            }
+            std::swap(cache, newCache);
+
+            // Rescore affected vertices and their triangles, picking the next best triangle among them
+            for (uint32_t vertex : cache) { vertexScores[vertex] = forsythVertexScore(cachePosition[vertex], remaining[vertex]); }
+            float bestScore = -1.0f;
+            bestTriangle    = -1;
+            for (uint32_t vertex : cache) {
+                for (uint32_t adjIdx = adjacencyOffsets[vertex]; adjIdx < adjacencyOffsets[vertex] + remaining[vertex]; adjIdx++) {
+                    const uint32_t triIdx       = adjacency[adjIdx];
+                    const glm::uvec3& adjTri    = triangles[triIdx];
+                    triangleScores[triIdx]      = vertexScores[adjTri.x] + vertexScores[adjTri.y] + vertexScores[adjTri.z];
+                    if (triangleScores[triIdx] > bestScore) {
+                        bestScore       = triangleScores[triIdx];
+                        bestTriangle    = triIdx;
+                    }
+                }
+            }
+
+            // Only the first VERTEX_CACHE_SIZE entries are really cached; the overflow was kept only to be rescored
+            if (cache.size() > VERTEX_CACHE_SIZE) { cache.resize(VERTEX_CACHE_SIZE); }
+        }
+        return result;
+    }
+
+    /********** Overdraw optimization **********/
+    // Split the cache-optimised order into clusters at cache restarts (where all three vertices miss) and draw clusters
+    // facing away from the mesh centre first, since those are most likely to occlude the rest (Sander et al., "Fast triangle reordering")
+    static std::vector<glm::uvec3> optimizeOverdraw(const std::vector<glm::uvec3>& triangles, const std::vector<Vertex>& vertices) {
+        if (triangles.empty()) { return triangles; }
+
+        // Cluster boundaries
+        std::vector<size_t> clusterStarts;
+        std::vector<size_t> insertionTime(vertices.size(), 0UL);
+        size_t time = VERTEX_CACHE_SIZE + 1UL;
+        for (size_t triIdx = 0UL; triIdx < triangles.size(); triIdx++) {
+            uint32_t misses = 0U;
+            for (int i = 0; i < 3; i++) {
+                size_t& inserted = insertionTime[triangles[triIdx][i]];
+                if (inserted == 0UL || time - inserted > VERTEX_CACHE_SIZE) {
+                    inserted = time++;
+                    misses++;
+                }
+            }
+            if (misses == 3U) { clusterStarts.push_back(triIdx); }
+        }
+        clusterStarts.push_back(triangles.size());
+
+        // Area-weighted mesh centroid
+        glm::vec3 meshCentroid(0.0f);
+        float meshArea = 0.0f;
+        for (const glm::uvec3& triangle : triangles) {
+            const glm::vec3 &p0 = vertices[triangle.x].position, &p1 = vertices[triangle.y].position, &p2 = vertices[triangle.z].position;
+            const float area    = glm::length(glm::cross(p1 - p0, p2 - p0));
+            meshCentroid        += area * (p0 + p1 + p2) / 3.0f;
+            meshArea            += area;
+        }
+        if (meshArea > 0.0f) { meshCentroid /= meshArea; }
+
+        // Sort key of each cluster is how much it faces away from the mesh centre
+        const size_t numClusters = clusterStarts.size() - 1UL;
+        std::vector<float> clusterSortKeys(numClusters);
+        for (size_t clusterIdx = 0UL; clusterIdx < numClusters; clusterIdx++) {
+            glm::vec3 centroid(0.0f), normal(0.0f);
+            float area = 0.0f;
+            for (size_t triIdx = clusterStarts[clusterIdx]; triIdx < clusterStarts[clusterIdx + 1UL]; triIdx++) {
+                const glm::uvec3& triangle = triangles[triIdx];
+                const glm::vec3 &p0 = vertices[triangle.x].position, &p1 = vertices[triangle.y].position, &p2 = vertices[triangle.z].position;
+                const glm::vec3 scaledNormal    = glm::cross(p1 - p0, p2 - p0);
+                const float triangleArea        = glm::length(scaledNormal);
+                centroid    += triangleArea * (p0 + p1 + p2) / 3.0f;
+                normal      += scaledNormal;
+                area        += triangleArea;
+            }
+            if (area > 0.0f)                    { centroid /= area; }
+            if (glm::length(normal) > 0.0f)     { normal = glm::normalize(normal); }
+            clusterSortKeys[clusterIdx] = glm::dot(centroid - meshCentroid, normal);
+        }
+
+        std::vector<size_t> clusterOrder(numClusters);
+        std::iota(clusterOrder.begin(), clusterOrder.end(), 0UL);
+        std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&clusterSortKeys](size_t a, size_t b) { return clusterSortKeys[a] > clusterSortKeys[b]; });
+
+        std::vector<glm::uvec3> result;
+        result.reserve(triangles.size());
+        for (size_t clusterIdx : clusterOrder) {
+            result.insert(result.end(), triangles.begin() + clusterStarts[clusterIdx], triangles.begin() + clusterStarts[clusterIdx + 1UL]);
+        }
+        return result;
+    }
+
+    /********** Vertex fetch optimization **********/
+    // Reorder vertices by first use so that vertex fetches walk memory linearly. Unreferenced vertices are dropped.
+    // The new index of every old vertex (UNMAPPED_VERTEX if dropped) is returned so per-vertex data kept elsewhere can follow
+    constexpr uint32_t UNMAPPED_VERTEX = 0xFFFFFFFF;
+    static std::vector<uint32_t> optimizeVertexFetch(Mesh& mesh) {
+        std::vector<uint32_t> remap(mesh.vertices.size(), UNMAPPED_VERTEX);
+        std::vector<Vertex> reordered;
+        reordered.reserve(mesh.vertices.size());
+        for (glm::uvec3& triangle : mesh.triangles) {
+            for (int i = 0; i < 3; i++) {
+                uint32_t& newIdx = remap[triangle[i]];
+                if (newIdx == UNMAPPED_VERTEX) {
+                    newIdx = static_cast<uint32_t>(reordered.size());
+                    reordered.push_back(mesh.vertices[triangle[i]]);
+                }
+                triangle[i] = newIdx;
+            }
+        }
+        mesh.vertices = std::move(reordered);
+        return remap;
+    }
+
+    /********** Full pipeline **********/
+    static MeshOptimizationStats optimizeMesh(Mesh& mesh, std::vector<uint32_t>* vertexRemap = nullptr) {
+        MeshOptimizationStats stats;
+        stats.acmrBefore = computeACMR(mesh.triangles, mesh.vertices.size());
+
+        // Overdraw ordering trades a little cache efficiency for less overdraw; only keep it if the trade is small
+        const std::vector<glm::uvec3> cacheOptimized    = optimizeVertexCache(mesh.triangles, mesh.vertices.size());
+        const float cacheOptimizedACMR                  = computeACMR(cacheOptimized, mesh.vertices.size());
+        std::vector<glm::uvec3> overdrawOptimized       = optimizeOverdraw(cacheOptimized, mesh.vertices);
+        if (computeACMR(overdrawOptimized, mesh.vertices.size()) <= cacheOptimizedACMR * OVERDRAW_ACMR_THRESHOLD)   { mesh.triangles = std::move(overdrawOptimized); }
+        else                                                                                                        { mesh.triangles = cacheOptimized; }
+
+        std::vector<uint32_t> remap = optimizeVertexFetch(mesh);
+        if (vertexRemap != nullptr) { *vertexRemap = std::move(remap); }
+        stats.acmrAfter = computeACMR(mesh.triangles, mesh.vertices.size());
+        return stats;
+    }
+}
+
+#endif
@@ -6,18 +6,15 @@ DISABLE_WARNINGS_PUSH()
 #include <glad/glad.h>
 DISABLE_WARNINGS_POP()
 
-#include <random>
+#include <utils/random.hpp>
 #include <vector>
 
 namespace utils {
     /********** Random number generation **********/
-    static std::random_device randomDevice;                 // Will be used to obtain a seed for the random number engine
-    static std::mt19937 randomGenerator(randomDevice());    // Standard mersenne_twister_engine seeded with randomDevice
-
+    // Uniform number in [low, high) from the calling thread's generator
     template<typename T>
     static T randomNumber(T low, T high) { 
-        std::uniform_real_distribution<T> distribution(low, high);
-        return distribution(randomGenerator);
+        return static_cast<T>(threadRandomGenerator().uniform(static_cast<float>(low), static_cast<float>(high)));
     }
 
     template<typename T>
@@ -27,22 +24,19 @@ namespace utils {
                                                 bool scaleMagnitude = true, bool acceleratingInterpolationScale = true,
                                                 const glm::vec2& magnitudeBounds = glm::vec2(0.0f, 1.0f)) {
         std::vector<glm::vec4> generatedVectors(numSamples, {0.0f, 0.0f, 0.0f, 0.0f});
-        std::uniform_real_distribution<float> xDistribution(xBounds.x, xBounds.y);
-        std::uniform_real_distribution<float> yDistribution(yBounds.x, yBounds.y);
-        std::uniform_real_distribution<float> zDistribution(zBounds.x, zBounds.y);
-        std::uniform_real_distribution<float> boundsDistribution(zBounds.x, zBounds.y);
+        RandomGenerator& randomGenerator = threadRandomGenerator();
 
         for (size_t sampleIdx = 0UL; sampleIdx < numSamples; sampleIdx++) {
             // Generate random vector using given bounds
             glm::vec4& sample   = generatedVectors[sampleIdx];
-            sample.x            = xDistribution(randomGenerator);
-            sample.y            = yDistribution(randomGenerator);
-            sample.z            = zDistribution(randomGenerator);
+            sample.x            = randomGenerator.uniform(xBounds.x, xBounds.y);
+            sample.y            = randomGenerator.uniform(yBounds.x, yBounds.y);
+            sample.z            = randomGenerator.uniform(zBounds.x, zBounds.y);
 
             // Set magnitude to given bounds if needed
             if (scaleMagnitude) {
                 sample  = glm::normalize(sample);
-                sample  *= boundsDistribution(randomGenerator);
+                sample  *= randomGenerator.uniform(zBounds.x, zBounds.y);
             }            
 
             // Scale samples closer to origin if acceleration interpolation is enabled
@@ -56,16 +50,6 @@ namespace utils {
     }
 
     /********** Geometric utilities **********/
-    static glm::vec4 quaternionToAxisAndDegrees(const glm::vec4& quaternion) {
-        glm::vec4 in        = glm::normalize(quaternion);
-        float angleRads     = acos(in.w) * 2.0f;
-        float angleDegrees  = angleRads * 180.0f / glm::pi<float>();
-        float x = in.x / sin(angleRads / 2.0f);
-        float y = in.y / sin(angleRads / 2.0f);
-        float z = in.z / sin(angleRads / 2.0f);
-        return glm::vec4(x, y, z, angleDegrees);
-    }
-
     static float eulerDistIgnoreW(glm::vec4 a, glm::vec4 b) { return sqrtf(pow(a.x - b.x, 2.0f) + pow(a.y - b.y, 2.0f) + pow(a.z - b.z, 2.0f)); }
 }
 
@@ -0,0 +1,60 @@
+#ifndef _RADIX_SORT_HPP_
+#define _RADIX_SORT_HPP_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <span>
+#include <stdint.h>
+#include <utility>
+
+namespace utils {
+    // Maps a float to an unsigned key with the same ordering (negative floats get all bits flipped, positive ones their sign bit)
+    static uint32_t sortableFloatKey(float value) {
+        const uint32_t bits = std::bit_cast<uint32_t>(value);
+        return (bits & 0x80000000U) ? ~bits : (bits | 0x80000000U);
+    }
+
+    // Stable LSD radix sort of (key, value) pairs by ascending key, one byte per pass. The scratch spans must be at least as large as
+    // the inputs; the result always ends up in keys and values. Passes in which every key shares the same byte are skipped
+    static void radixSortPairs(std::span<uint32_t> keys, std::span<uint32_t> values, std::span<uint32_t> scratchKeys, std::span<uint32_t> scratchValues) {
+        constexpr uint32_t RADIX_BITS   = 8U;
+        constexpr uint32_t RADIX_SIZE   = 1U << RADIX_BITS;
+        constexpr uint32_t NUM_PASSES   = 32U / RADIX_BITS;
+        const size_t numPairs           = keys.size();
+
+        // Histograms of all passes in a single read of the keys
+        std::array<std::array<uint32_t, RADIX_SIZE>, NUM_PASSES> histograms {};
+        for (uint32_t key : keys) {
+            for (uint32_t pass = 0U; pass < NUM_PASSES; pass++) { histograms[pass][(key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1U)]++; }
+        }
+
+        std::span<uint32_t> sourceKeys = keys, sourceValues = values, destinationKeys = scratchKeys, destinationValues = scratchValues;
+        for (uint32_t pass = 0U; pass < NUM_PASSES; pass++) {
+            std::array<uint32_t, RADIX_SIZE>& histogram = histograms[pass];
+            const uint32_t shift                        = pass * RADIX_BITS;
+            if (numPairs == 0UL || histogram[(sourceKeys[0] >> shift) & (RADIX_SIZE - 1U)] == numPairs) { continue; }
+
+            // Histogram to exclusive prefix sums (destination offset of every digit)
+            uint32_t offset = 0U;
+            for (uint32_t& count : histogram) { offset += std::exchange(count, offset); }
+
+            for (size_t pairIdx = 0UL; pairIdx < numPairs; pairIdx++) {
+                const uint32_t key                  = sourceKeys[pairIdx];
+                const uint32_t destinationIdx       = histogram[(key >> shift) & (RADIX_SIZE - 1U)]++;
+                destinationKeys[destinationIdx]     = key;
+                destinationValues[destinationIdx]   = sourceValues[pairIdx];
+            }
+            std::swap(sourceKeys, destinationKeys);
+            std::swap(sourceValues, destinationValues);
+        }
+
+        // Odd number of executed passes leaves the result in the scratch buffers
+        if (sourceKeys.data() != keys.data()) {
+            std::copy_n(sourceKeys.begin(), numPairs, keys.begin());
+            std::copy_n(sourceValues.begin(), numPairs, values.begin());
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef _RANDOM_HPP_
+#define _RANDOM_HPP_
+
+#include <utils/simd.hpp>
+#include <array>
+#include <atomic>
+#include <random>
+#include <span>
+#include <stdint.h>
+
+namespace utils {
+    // splitmix64 (Steele, Lea & Flood), used to expand a single seed into well-mixed generator state
+    inline uint64_t splitMix64(uint64_t& state) {
+        uint64_t mixed = (state += 0x9E3779B97F4A7C15ULL);
+        mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBULL;
+        return mixed ^ (mixed >> 31);
+    }
+
+    // Four independent xoshiro128+ streams (Blackman & Vigna) advanced in lockstep, one per SIMD lane. Cheap to copy and not
+    // thread-safe by design: every thread uses its own generator (see threadRandomGenerator)
+    class RandomGenerator {
+    public:
+        explicit RandomGenerator(uint64_t seed) {
+            uint64_t splitMixState = seed;
+            for (size_t lane = 0UL; lane < LANES; lane++) {
+                for (size_t word = 0UL; word < LANES; word += 2UL) {
+                    const uint64_t bits         = splitMix64(splitMixState);
+                    m_state[word][lane]         = static_cast<uint32_t>(bits);
+                    m_state[word + 1UL][lane]   = static_cast<uint32_t>(bits >> 32);
+                }
+            }
+        }
+
+        // Uniform float in [low, high)
+        float uniform(float low, float high) {
+            if (m_bufferIdx == LANES) {
+                nextUnitFloats().store(m_buffer.data());
+                m_bufferIdx = 0UL;
+            }
+            return low + (high - low) * m_buffer[m_bufferIdx++];
+        }
+
+        // Fills values with uniform floats in [low, high), a whole vector per step
+        void fillUniform(std::span<float> values, float low, float high) {
+            const Float4 scale  = Float4::broadcast(high - low);
+            const Float4 offset = Float4::broadcast(low);
+            size_t valueIdx     = 0UL;
+            for (; valueIdx + LANES <= values.size(); valueIdx += LANES) { Float4::multiplyAdd(nextUnitFloats(), scale, offset).store(&values[valueIdx]); }
+            for (; valueIdx < values.size(); valueIdx++)                 { values[valueIdx] = uniform(low, high); }
+        }
+
+    private:
+        static constexpr size_t LANES = 4UL;
+
+        // Advances every stream once; the top 24 bits of each output become a float in [0, 1)
+        Float4 nextUnitFloats() {
+#ifdef UTILS_SIMD_SSE2
+            __m128i s0              = _mm_load_si128(reinterpret_cast<const __m128i*>(m_state[0].data()));
+            __m128i s1              = _mm_load_si128(reinterpret_cast<const __m128i*>(m_state[1].data()));
+            __m128i s2              = _mm_load_si128(reinterpret_cast<const __m128i*>(m_state[2].data()));
+            __m128i s3              = _mm_load_si128(reinterpret_cast<const __m128i*>(m_state[3].data()));
+            const __m128i result    = _mm_add_epi32(s0, s3);
+            const __m128i shifted   = _mm_slli_epi32(s1, 9);
+            s2                      = _mm_xor_si128(s2, s0);
+            s3                      = _mm_xor_si128(s3, s1);
+            s1                      = _mm_xor_si128(s1, s2);
+            s0                      = _mm_xor_si128(s0, s3);
+            s2                      = _mm_xor_si128(s2, shifted);
+            s3                      = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+            _mm_store_si128(reinterpret_cast<__m128i*>(m_state[0].data()), s0);
+            _mm_store_si128(reinterpret_cast<__m128i*>(m_state[1].data()), s1);
+            _mm_store_si128(reinterpret_cast<__m128i*>(m_state[2].data()), s2);
+            _mm_store_si128(reinterpret_cast<__m128i*>(m_state[3].data()), s3);
+            return { _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(result, 8)), _mm_set1_ps(0x1.0p-24f)) };
+#else
+            Float4 unitFloats;
+            for (size_t lane = 0UL; lane < LANES; lane++) {
+                const uint32_t result   = m_state[0][lane] + m_state[3][lane];
+                const uint32_t shifted  = m_state[1][lane] << 9;
+                m_state[2][lane]        ^= m_state[0][lane];
+                m_state[3][lane]        ^= m_state[1][lane];
+                m_state[1][lane]        ^= m_state[2][lane];
+                m_state[0][lane]        ^= m_state[3][lane];
+                m_state[2][lane]        ^= shifted;
+                m_state[3][lane]        = (m_state[3][lane] << 11) | (m_state[3][lane] >> 21);
+                unitFloats.value[lane]  = static_cast<float>(result >> 8) * 0x1.0p-24f;
+            }
+            return unitFloats;
+#endif
+        }
+
+        alignas(16) std::array<std::array<uint32_t, LANES>, LANES> m_state; // Word-major, so each state word of all streams is one vector
+        std::array<float, LANES> m_buffer;                                  // Unused outputs of the last step, consumed by uniform()
+        size_t m_bufferIdx { LANES };
+    };
+
+    // Per-thread generators are seeded from a base seed and the order in which threads first use one. Runs are reproducible after
+    // seedRandom (as long as threads start drawing numbers in the same order); otherwise the base seed comes from the random device
+    inline std::atomic<uint64_t> randomSeedBase { std::random_device {}() };
+    inline std::atomic<uint64_t> randomThreadCounter { 0ULL };
+
+    // The thread index is hashed into the seed: seeds a fixed step apart would start the generators' splitmix64 expansions on
+    // the same sequence, merely shifted, leaving the streams of neighbouring threads correlated
+    inline uint64_t threadRandomSeed(uint64_t base, uint64_t threadIdx) {
+        uint64_t state = base ^ threadIdx;
+        return splitMix64(state);
+    }
+
+    inline RandomGenerator& threadRandomGenerator() {
+        thread_local RandomGenerator generator(threadRandomSeed(randomSeedBase.load(), randomThreadCounter.fetch_add(1ULL)));
+        return generator;
+    }
+
+    // Reseeds the calling thread's generator immediately and those of other threads as they are created
+    inline void seedRandom(uint64_t seed) {
+        RandomGenerator& generator = threadRandomGenerator();
+        randomSeedBase      = seed;
+        randomThreadCounter = 1ULL;
+        generator           = RandomGenerator(threadRandomSeed(seed, 0ULL));
+    }
+}
+
+#endif
@@ -68,7 +68,7 @@ namespace utils {
                 // Render a mesh if this node actually contains one
                 if (meshNode->mesh != nullptr) {
                     const GPUMesh& mesh                         = *(meshNode->mesh);
-                    const glm::mat4& modelMatrix                = meshNode->modelMatrix();
+                    const glm::mat4 modelMatrix                 = meshNode->modelMatrix() * mesh.dequantizationMatrix(); // Shadows only need positions
                     const std::array<glm::mat4, 6U> lightMvps   = light.genMvpMatrices(modelMatrix, pointLightShadowMapsProjection);
 
                     // Render each cubemap face
@@ -83,6 +83,7 @@ namespace utils {
                         glUniformMatrix4fv(1, 1, GL_FALSE, glm::value_ptr(modelMatrix));
                         glUniform3fv(2, 1, glm::value_ptr(light.position));
                         glUniform1f(3, m_renderConfig.shadowFarPlane);
+                        mesh.bindMorphTargets();
 
                         // Bind model's VAO and draw its elements
                         mesh.draw();
@@ -121,11 +122,12 @@ namespace utils {
             // Render a mesh if this node actually contains one
             if (meshNode->mesh != nullptr) {
                 const GPUMesh& mesh             = *(meshNode->mesh);
-                const glm::mat4& modelMatrix    = meshNode->modelMatrix();
+                const glm::mat4 modelMatrix     = meshNode->modelMatrix() * mesh.dequantizationMatrix(); // Shadows only need positions
                     
                 // Bind light camera mvp matrix
                 const glm::mat4 lightMvp = areaLightShadowMapsProjection * lightView *  modelMatrix;
                 glUniformMatrix4fv(0, 1, GL_FALSE, glm::value_ptr(lightMvp));
+                mesh.bindMorphTargets();
 
                 // Bind model's VAO and draw its elements
                 mesh.draw();
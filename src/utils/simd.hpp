@@ -0,0 +1,66 @@
+#ifndef _SIMD_HPP_
+#define _SIMD_HPP_
+
+// SSE2 is part of every x86-64 target, so it needs no runtime detection. Other targets get a scalar fallback with the same interface
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UTILS_SIMD_SSE2 1
+#include <emmintrin.h>
+#else
+#include <bit>
+#include <cmath>
+#endif
+
+namespace utils {
+    // Four packed floats. Loads and stores are unaligned, since glm types and std::vector storage only guarantee 4-byte alignment
+    struct Float4 {
+#ifdef UTILS_SIMD_SSE2
+        __m128 value;
+
+        static Float4 load(const float* source)     { return { _mm_loadu_ps(source) }; }
+        static Float4 broadcast(float scalar)       { return { _mm_set1_ps(scalar) }; }
+        void store(float* destination) const        { _mm_storeu_ps(destination, value); }
+
+        friend Float4 operator+(Float4 lhs, Float4 rhs) { return { _mm_add_ps(lhs.value, rhs.value) }; }
+        friend Float4 operator-(Float4 lhs, Float4 rhs) { return { _mm_sub_ps(lhs.value, rhs.value) }; }
+        friend Float4 operator*(Float4 lhs, Float4 rhs) { return { _mm_mul_ps(lhs.value, rhs.value) }; }
+        friend Float4 min(Float4 lhs, Float4 rhs)       { return { _mm_min_ps(lhs.value, rhs.value) }; }
+        friend Float4 max(Float4 lhs, Float4 rhs)       { return { _mm_max_ps(lhs.value, rhs.value) }; }
+
+        // Lanes of comparisons are all ones where true and all zeroes where false; signMask packs one bit per lane (lane 0 in bit 0)
+        static Float4 greaterThan(Float4 lhs, Float4 rhs)   { return { _mm_cmpgt_ps(lhs.value, rhs.value) }; }
+        int signMask() const                                { return _mm_movemask_ps(value); }
+#else
+        float value[4];
+
+        static Float4 load(const float* source)     { return { { source[0], source[1], source[2], source[3] } }; }
+        static Float4 broadcast(float scalar)       { return { { scalar, scalar, scalar, scalar } }; }
+        void store(float* destination) const        { for (int lane = 0; lane < 4; lane++) { destination[lane] = value[lane]; } }
+
+        template <typename Op>
+        static Float4 lanewise(Float4 lhs, Float4 rhs, Op op) {
+            Float4 result;
+            for (int lane = 0; lane < 4; lane++) { result.value[lane] = op(lhs.value[lane], rhs.value[lane]); }
+            return result;
+        }
+        friend Float4 operator+(Float4 lhs, Float4 rhs) { return lanewise(lhs, rhs, [](float a, float b) { return a + b; }); }
+        friend Float4 operator-(Float4 lhs, Float4 rhs) { return lanewise(lhs, rhs, [](float a, float b) { return a - b; }); }
+        friend Float4 operator*(Float4 lhs, Float4 rhs) { return lanewise(lhs, rhs, [](float a, float b) { return a * b; }); }
+        friend Float4 min(Float4 lhs, Float4 rhs)       { return lanewise(lhs, rhs, [](float a, float b) { return a < b ? a : b; }); }
+        friend Float4 max(Float4 lhs, Float4 rhs)       { return lanewise(lhs, rhs, [](float a, float b) { return a > b ? a : b; }); }
+
+        static Float4 greaterThan(Float4 lhs, Float4 rhs) {
+            return lanewise(lhs, rhs, [](float a, float b) { return std::bit_cast<float>(a > b ? 0xFFFFFFFFU : 0U); });
+        }
+        int signMask() const {
+            int mask = 0;
+            for (int lane = 0; lane < 4; lane++) { mask |= std::signbit(value[lane]) ? (1 << lane) : 0; }
+            return mask;
+        }
+#endif
+
+        // a * b + c (separate multiply and add: FMA is not part of SSE2 and would change results between the two paths)
+        static Float4 multiplyAdd(Float4 a, Float4 b, Float4 c) { return a * b + c; }
+    };
+}
+
+#endif
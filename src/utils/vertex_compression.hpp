@@ -0,0 +1,87 @@
+#ifndef _VERTEX_COMPRESSION_HPP_
+#define _VERTEX_COMPRESSION_HPP_
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/type_precision.hpp>
+#include <glm/packing.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+DISABLE_WARNINGS_POP()
+#include <framework/mesh.h>
+
+#include <stdint.h>
+
+// GPU vertex layout (20 bytes). Decoded in shaders/deferred/deferred.vert and shaders/deferred/deferred_indirect.vert
+struct CompactVertex {
+    glm::u16vec4 position;  // XYZ are unorm16 relative to the mesh's bounding box, W is the bitangent sign (0 => -1, 65535 => +1)
+    glm::i16vec2 normal;    // Octahedral-encoded, snorm16
+    glm::uint32 texCoord;   // Two half floats
+    glm::i16vec2 tangent;   // Octahedral-encoded, snorm16
+};
+static_assert(sizeof(CompactVertex) == 20UL);
+
+// Per-pose vertex data of morph target animations (8 bytes). Decoded in shaders/deferred/deferred.vert and the shadow vertex shaders
+struct MorphVertex {
+    glm::u16vec3 position;  // Unorm16 relative to the mesh's bounding box (same space as CompactVertex::position)
+    glm::u8vec2 normal;     // Octahedral-encoded, unorm8
+};
+static_assert(sizeof(MorphVertex) == 8UL);
+
+namespace utils {
+    // Octahedral unit vector encoding (https://jcgt.org/published/0003/02/01/)
+    inline glm::vec2 octahedralEncode(const glm::vec3& unitVector) {
+        const glm::vec3 octahedron  = unitVector / (glm::abs(unitVector.x) + glm::abs(unitVector.y) + glm::abs(unitVector.z));
+        const glm::vec2 xy          = glm::vec2(octahedron);
+        if (octahedron.z >= 0.0f) { return xy; }
+
+        // Fold lower hemisphere over the diagonals
+        const glm::vec2 signNotZero(xy.x >= 0.0f ? 1.0f : -1.0f, xy.y >= 0.0f ? 1.0f : -1.0f);
+        return (1.0f - glm::abs(glm::vec2(xy.y, xy.x))) * signNotZero;
+    }
+
+    inline glm::i16vec2 packSnorm16(const glm::vec2& value) {
+        const glm::vec2 scaled = glm::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f);
+        return glm::i16vec2(static_cast<int16_t>(scaled.x), static_cast<int16_t>(scaled.y));
+    }
+
+    // Scale mapping quantised [0, 1] positions back onto the bounding box (flat axes are padded to avoid division by zero)
+    inline glm::vec3 positionScale(const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+        return glm::max(boundsMax - boundsMin, glm::vec3(1e-6f));
+    }
+
+    // Positions are quantised relative to the given bounding box, which must be used again to decode them
+    inline CompactVertex compressVertex(const Vertex& vertex, const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+        const glm::vec3 normalized  = glm::clamp((vertex.position - boundsMin) / positionScale(boundsMin, boundsMax), 0.0f, 1.0f);
+        const glm::vec3 quantized   = glm::round(normalized * 65535.0f);
+
+        // Only the bitangent's handedness is stored, the shader reconstructs it from the normal and tangent
+        const glm::vec3 normal          = glm::length(vertex.normal)  > 0.0f ? glm::normalize(vertex.normal)  : glm::vec3(0.0f, 0.0f, 1.0f);
+        const glm::vec3 tangent         = glm::length(vertex.tangent) > 0.0f ? glm::normalize(vertex.tangent) : glm::vec3(1.0f, 0.0f, 0.0f);
+        const bool positiveBitangent    = glm::dot(glm::cross(normal, tangent), vertex.bitangent) >= 0.0f;
+
+        CompactVertex compact;
+        compact.position    = glm::u16vec4(static_cast<uint16_t>(quantized.x), static_cast<uint16_t>(quantized.y), static_cast<uint16_t>(quantized.z),
+                                           positiveBitangent ? uint16_t(65535U) : uint16_t(0U));
+        compact.normal      = packSnorm16(octahedralEncode(normal));
+        compact.texCoord    = glm::packHalf2x16(vertex.texCoord);
+        compact.tangent     = packSnorm16(octahedralEncode(tangent));
+        return compact;
+    }
+
+    // Morph poses only store what changes noticeably between poses; tangents are re-orthogonalised against the blended normal in the shader
+    inline MorphVertex compressMorphVertex(const Vertex& vertex, const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+        const glm::vec3 normalized  = glm::clamp((vertex.position - boundsMin) / positionScale(boundsMin, boundsMax), 0.0f, 1.0f);
+        const glm::vec3 quantized   = glm::round(normalized * 65535.0f);
+        const glm::vec3 normal      = glm::length(vertex.normal) > 0.0f ? glm::normalize(vertex.normal) : glm::vec3(0.0f, 0.0f, 1.0f);
+        const glm::vec2 octNormal   = glm::round((octahedralEncode(normal) * 0.5f + 0.5f) * 255.0f);
+        MorphVertex morph;
+        morph.position  = glm::u16vec3(static_cast<uint16_t>(quantized.x), static_cast<uint16_t>(quantized.y), static_cast<uint16_t>(quantized.z));
+        morph.normal    = glm::u8vec2(static_cast<uint8_t>(octNormal.x), static_cast<uint8_t>(octNormal.y));
+        return morph;
+    }
+}
+
+#endif